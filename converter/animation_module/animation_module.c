@@ -18,9 +18,16 @@
   #include <cglm/io.h>
 #endif
 
+#include <cglm/affine.h>
 #include <cglm/mat4.h>
+#include <cglm/quat.h>
 
+#include <assert.h>
+#include <math.h>
 #include <stdlib.h>
+#include <string.h>
+
+#define JOINT_MATRIX_ALIGNMENT 16 // The inverse bind matrices follow the parent indices at this alignment
 
 static AnalyzerNode* analyzer_nodes;
 
@@ -103,6 +110,9 @@ void anim_create(const cgltf_data* input_file)
         }
       }
 
+      // Parents need to come before their children so that global transforms can be built in a single pass
+      sort_joints_parents_first(joints, joint_count);
+
       // Find the correct parent indices for all joints
       calculate_joint_parent_indices(joints, joint_count);
 
@@ -200,20 +210,188 @@ void anim_calculate_global_node_transform(cgltf_node* node, mat4 transform)
   calculate_global_node_transform(node, transform);
 }
 
+// Blends linearly between the keyframes around the given time and holds the first and last keyframe outside of them,
+// the same way as libaem does
+static void sample_keyframes(const Keyframe* channel_keyframes,
+                             uint32_t channel_keyframe_count,
+                             float time,
+                             bool is_rotation,
+                             vec4 out)
+{
+  uint32_t keyframe_index = 0;
+  while (keyframe_index < channel_keyframe_count && channel_keyframes[keyframe_index].time <= time)
+  {
+    ++keyframe_index;
+  }
+
+  if (keyframe_index == 0 || keyframe_index == channel_keyframe_count)
+  {
+    glm_vec4_copy((float*)channel_keyframes[keyframe_index == 0 ? 0 : channel_keyframe_count - 1].data, out);
+    return;
+  }
+
+  const Keyframe* from = &channel_keyframes[keyframe_index - 1];
+  const Keyframe* to = &channel_keyframes[keyframe_index];
+  const float blend = (time - from->time) / (to->time - from->time);
+
+  vec4 to_data;
+  glm_vec4_copy((float*)to->data, to_data);
+  if (is_rotation && glm_vec4_dot((float*)from->data, to_data) < 0.0f)
+  {
+    glm_vec4_negate(to_data); // Take the shorter way around
+  }
+
+  glm_vec4_lerp((float*)from->data, to_data, blend, out);
+  if (is_rotation)
+  {
+    glm_quat_normalize(out);
+  }
+}
+
+mat4* anim_calculate_sampled_skinning_matrices(uint32_t* pose_count)
+{
+  *pose_count = 0;
+  for (uint32_t animation_index = 0; animation_index < animation_count; ++animation_index)
+  {
+    *pose_count += (uint32_t)ceilf(animations[animation_index].duration * BOUNDS_SAMPLE_RATE) + 1;
+  }
+
+  if (*pose_count == 0 || joint_count == 0)
+  {
+    *pose_count = 0;
+    return NULL;
+  }
+
+  mat4* skinning_matrices = malloc(sizeof(mat4) * joint_count * *pose_count);
+  mat4* global_transforms = malloc(sizeof(mat4) * joint_count);
+  uint32_t* keyframe_counts = malloc(sizeof(uint32_t) * joint_count * 3); // Translation, rotation and scale per joint
+  assert(skinning_matrices && global_transforms && keyframe_counts);
+
+  uint32_t pose_index = 0, first_keyframe_index = 0;
+  for (uint32_t animation_index = 0; animation_index < animation_count; ++animation_index)
+  {
+    const Animation* animation = &animations[animation_index];
+
+    // The keyframes of each joint are laid out like the tracks describe them
+    uint32_t animation_keyframe_count = 0;
+    for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+    {
+      cgltf_animation_channel *translation_channel, *rotation_channel, *scale_channel;
+      find_animation_channels_for_node(animation->animation, joints[joint_index].analyzer_node->node,
+                                       &translation_channel, &rotation_channel, &scale_channel);
+
+      uint32_t* counts = &keyframe_counts[joint_index * 3];
+      counts[0] = determine_keyframe_count_for_channel(translation_channel);
+      counts[1] = determine_keyframe_count_for_channel(rotation_channel);
+      counts[2] = determine_keyframe_count_for_channel(scale_channel);
+      animation_keyframe_count += counts[0] + counts[1] + counts[2];
+    }
+
+    const uint32_t sample_count = (uint32_t)ceilf(animation->duration * BOUNDS_SAMPLE_RATE) + 1;
+    for (uint32_t sample_index = 0; sample_index < sample_count; ++sample_index, ++pose_index)
+    {
+      const float time = glm_min(sample_index / BOUNDS_SAMPLE_RATE, animation->duration);
+
+      const Keyframe* joint_keyframes = &keyframes[first_keyframe_index];
+      for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+      {
+        const Joint* joint = &joints[joint_index];
+        const uint32_t* counts = &keyframe_counts[joint_index * 3];
+
+        vec4 translation, rotation, scale;
+        sample_keyframes(joint_keyframes, counts[0], time, false, translation);
+        sample_keyframes(&joint_keyframes[counts[0]], counts[1], time, true, rotation);
+        sample_keyframes(&joint_keyframes[counts[0] + counts[1]], counts[2], time, false, scale);
+        joint_keyframes += counts[0] + counts[1] + counts[2];
+
+        // Parents come first, so their global transform is always ready
+        mat4 local_transform;
+        glm_translate_make(local_transform, translation);
+        glm_quat_rotate(local_transform, rotation, local_transform);
+        glm_scale(local_transform, scale);
+
+        if (joint->parent_index >= 0)
+        {
+          glm_mat4_mul(global_transforms[joint->parent_index], local_transform, global_transforms[joint_index]);
+        }
+        else
+        {
+          glm_mat4_copy(local_transform, global_transforms[joint_index]);
+        }
+
+        glm_mat4_mul(global_transforms[joint_index], (vec4*)joint->inverse_bind_matrix,
+                     skinning_matrices[pose_index * joint_count + joint_index]);
+      }
+    }
+
+    first_keyframe_index += animation_keyframe_count;
+  }
+
+  free(global_transforms);
+  free(keyframe_counts);
+
+  return skinning_matrices;
+}
+
+static const char* get_joint_name(const Joint* joint)
+{
+  const char* name = joint->analyzer_node->node->name;
+  return name ? name : "";
+}
+
+// Twice as many buckets as joints keeps the probe sequences of the name lookup short
+static uint32_t get_joint_name_bucket_count()
+{
+  return joint_count * 2;
+}
+
+uint64_t anim_calculate_joint_names_size()
+{
+  if (joint_count == 0)
+  {
+    return 0;
+  }
+
+  // Bucket count, name offsets and buckets
+  uint64_t size = sizeof(uint32_t) * (1 + joint_count + get_joint_name_bucket_count());
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    size += strlen(get_joint_name(&joints[joint_index])) + 1;
+  }
+
+  return size;
+}
+
 void anim_write_joints(FILE* output_file)
 {
+  // The parent indices come first so that traversing the skeleton doesn't touch the matrices
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    fwrite(&joints[joint_index].parent_index, sizeof(joints[joint_index].parent_index), 1, output_file);
+  }
+
+  {
+    const uint8_t padding[JOINT_MATRIX_ALIGNMENT] = { 0 };
+    const uint32_t parent_indices_size = joint_count * sizeof(int32_t);
+    fwrite(padding, 1, (JOINT_MATRIX_ALIGNMENT - parent_indices_size % JOINT_MATRIX_ALIGNMENT) % JOINT_MATRIX_ALIGNMENT,
+           output_file);
+  }
+
   for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
   {
     Joint* joint = &joints[joint_index];
 
-    char name[AEM_STRING_SIZE];
+    // The last row of an affine transform is always [0, 0, 0, 1], so only the first three rows are written
+    float inverse_bind_matrix[12];
+    for (uint32_t row = 0; row < 3; ++row)
     {
-      sprintf(name, "%s", joint->analyzer_node->node->name); // Null-terminates string
-      fwrite(name, AEM_STRING_SIZE, 1, output_file);
+      for (uint32_t column = 0; column < 4; ++column)
+      {
+        inverse_bind_matrix[row * 4 + column] = joint->inverse_bind_matrix[column][row];
+      }
     }
 
-    fwrite(&joint->inverse_bind_matrix, sizeof(joint->inverse_bind_matrix), 1, output_file);
-    fwrite(&joint->parent_index, sizeof(joint->parent_index), 1, output_file);
+    fwrite(inverse_bind_matrix, sizeof(inverse_bind_matrix), 1, output_file);
 
 #ifdef PRINT_JOINTS
     printf("Joint #%lu \"%s\":\n", joint_index, joint->analyzer_node->node->name);
@@ -225,6 +403,53 @@ void anim_write_joints(FILE* output_file)
   }
 }
 
+void anim_write_joint_names(FILE* output_file)
+{
+  if (joint_count == 0)
+  {
+    return;
+  }
+
+  const uint32_t bucket_count = get_joint_name_bucket_count();
+  fwrite(&bucket_count, sizeof(bucket_count), 1, output_file);
+
+  // Name offsets
+  {
+    uint32_t name_offset = 0;
+    for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+    {
+      fwrite(&name_offset, sizeof(name_offset), 1, output_file);
+      name_offset += (uint32_t)strlen(get_joint_name(&joints[joint_index])) + 1;
+    }
+  }
+
+  // Buckets hold the joint index + 1, collisions go to the next free bucket
+  {
+    uint32_t* buckets = calloc(bucket_count, sizeof(uint32_t));
+    assert(buckets);
+
+    for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+    {
+      uint32_t bucket_index = aem_hash_joint_name(get_joint_name(&joints[joint_index])) % bucket_count;
+      while (buckets[bucket_index] != 0)
+      {
+        bucket_index = (bucket_index + 1) % bucket_count;
+      }
+
+      buckets[bucket_index] = joint_index + 1;
+    }
+
+    fwrite(buckets, sizeof(uint32_t), bucket_count, output_file);
+    free(buckets);
+  }
+
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    const char* name = get_joint_name(&joints[joint_index]);
+    fwrite(name, strlen(name) + 1, 1, output_file);
+  }
+}
+
 void anim_write_animations(FILE* output_file)
 {
   uint32_t keyframe_index = 0;
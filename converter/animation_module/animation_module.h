@@ -13,13 +13,19 @@ void anim_create(const cgltf_data* input_file);
 
 uint32_t anim_get_joint_count();
 uint32_t anim_get_keyframe_count();
+uint64_t anim_calculate_joint_names_size();
 
 int32_t anim_calculate_joint_index_for_node(const cgltf_node* node);
 bool anim_does_joint_exist_for_node(const cgltf_node* node);
 
 void anim_calculate_global_node_transform(cgltf_node* node, mat4 transform);
 
+// Samples every animation at the bounds sample rate and returns the skinning matrix of each joint in each of those
+// poses, pose after pose, to be freed by the caller. Returns NULL if there are no joints or animations.
+mat4* anim_calculate_sampled_skinning_matrices(uint32_t* pose_count);
+
 void anim_write_joints(FILE* output_file);
+void anim_write_joint_names(FILE* output_file);
 void anim_write_animations(FILE* output_file);
 void anim_write_tracks(FILE* output_file);
 void anim_write_keyframes(FILE* output_file);
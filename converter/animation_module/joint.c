@@ -9,6 +9,36 @@
 
 #include <assert.h>
 
+static uint32_t get_node_depth(const AnalyzerNode* node)
+{
+  uint32_t depth = 0;
+  for (const AnalyzerNode* n_ptr = node->parent; n_ptr; n_ptr = n_ptr->parent)
+  {
+    ++depth;
+  }
+
+  return depth;
+}
+
+void sort_joints_parents_first(Joint* joints, uint32_t joint_count)
+{
+  // Stable insertion sort by node depth, ancestors are always less deep than their descendants
+  for (uint32_t joint_index = 1; joint_index < joint_count; ++joint_index)
+  {
+    const Joint joint = joints[joint_index];
+    const uint32_t depth = get_node_depth(joint.analyzer_node);
+
+    uint32_t sorted_index = joint_index;
+    while (sorted_index > 0 && get_node_depth(joints[sorted_index - 1].analyzer_node) > depth)
+    {
+      joints[sorted_index] = joints[sorted_index - 1];
+      --sorted_index;
+    }
+
+    joints[sorted_index] = joint;
+  }
+}
+
 void calculate_joint_parent_indices(Joint* joints, uint32_t joint_count)
 {
   for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
@@ -20,6 +20,7 @@ struct Joint
 
 typedef struct Joint Joint;
 
+void sort_joints_parents_first(Joint* joints, uint32_t joint_count);
 void calculate_joint_parent_indices(Joint* joints, uint32_t joint_count);
 void calculate_joint_inverse_bind_matrices(const cgltf_data* input_file, Joint* joints, uint32_t joint_count);
 void calculate_joint_pre_transforms(Joint* joints, uint32_t joint_count);
@@ -3,6 +3,41 @@
 // Compress textures for faster load times, but takes significantly longer to convert
 #define COMPRESS_TEXTURES
 
+// Quantize vertices to less than half their size, see AEM_VERTEX_FORMAT_QUANTIZED
+#define QUANTIZE_VERTICES
+
+// Store the indices of meshes with no more than 65536 vertices as 16-bit
+#define COMPACT_INDICES
+
+// Store positions and skinning data in their own stream so that depth-only passes fetch less data
+#define SPLIT_VERTEX_STREAMS
+
+// Merge vertices that are identical within the epsilons below, 0 only merges exact duplicates
+#define WELD_VERTICES
+#define WELD_POSITION_EPSILON 1e-6f // In model units, after the node transforms have been applied
+#define WELD_NORMAL_EPSILON 1e-4f   // Per component, also used for tangents and bitangents
+#define WELD_UV_EPSILON 1e-5f
+#define WELD_WEIGHT_EPSILON 1e-3f
+
+// Reorder triangles for the post-transform vertex cache and against overdraw, then vertices for fetch locality
+#define OPTIMIZE_MESHES
+#define VERTEX_CACHE_SIZE 16     // Entries of the post-transform vertex cache that is optimized for
+#define OVERDRAW_THRESHOLD 1.05f // How much worse the vertex cache may get to reduce overdraw
+
+// Generate simplified LODs of each mesh that share its vertices
+#define GENERATE_LODS
+#define LOD_RATIOS { 0.5f, 0.25f, 0.125f } // Target triangle count of each LOD relative to the mesh
+#define LOD_ERROR_BUDGET 0.02f             // Largest error of a LOD relative to the diagonal of the mesh bounds
+#define LOD_MIN_REDUCTION 0.9f             // Stop once a LOD keeps more than this ratio of the previous triangles
+
+// Split each mesh into meshlets with culling bounds, which regroups its triangles
+#define GENERATE_MESHLETS
+#define MESHLET_MAX_VERTEX_COUNT 64
+#define MESHLET_MAX_TRIANGLE_COUNT 124
+
+// Poses per second that animations are sampled at to find the extent of skinned meshes for their bounds
+#define BOUNDS_SAMPLE_RATE 30.0f
+
 // Skip optional steps to improve performance
 // #define SKIP_INPUT_VALIDATION // Provided by cgltf
 
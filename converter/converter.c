@@ -86,16 +86,25 @@ static bool export_file(char* filepath)
   geo_create(input_file);
 
   write_header(input_file, output_file);
-  geo_write_vertex_buffer(output_file);
-  geo_write_index_buffer(output_file);
-  mat_write_image_buffer(output_file);
-  mat_write_textures(output_file);
-  geo_write_meshes(output_file);
-  mat_write_materials(output_file);
-  anim_write_joints(output_file);
-  anim_write_animations(output_file);
-  anim_write_tracks(output_file);
-  anim_write_keyframes(output_file);
+
+  // Write the sections in the order of the section enum, each one is recorded in the table of contents
+  {
+    void (*const section_writers[AEMModelSection_Count])(FILE * output_file) = {
+      geo_write_vertex_buffer, geo_write_position_buffer, geo_write_index_buffer, mat_write_image_buffer,
+      mat_write_textures,      geo_write_meshes,          mat_write_materials,    anim_write_joints,
+      anim_write_animations,   anim_write_tracks,         anim_write_keyframes,   anim_write_joint_names,
+      geo_write_mesh_lods,     geo_write_meshlets,        geo_write_bounds
+    };
+
+    for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+    {
+      begin_section(section, output_file);
+      section_writers[section](output_file);
+      end_section(section, output_file);
+    }
+
+    write_section_table(output_file);
+  }
 
   mat_free();
   geo_free();
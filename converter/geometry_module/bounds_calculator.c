@@ -0,0 +1,175 @@
+#include "bounds_calculator.h"
+
+#include "output_mesh.h"
+
+#include <cglm/mat4.h>
+#include <cglm/vec3.h>
+
+#include <assert.h>
+#include <float.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static void init_bounds(OutputBounds* bounds)
+{
+  glm_vec3_broadcast(FLT_MAX, bounds->min);
+  glm_vec3_broadcast(-FLT_MAX, bounds->max);
+  bounds->radius = 0.0f;
+}
+
+// Corner 0 is the minimum and corner 7 the maximum of the box
+static void get_box_corner(const vec3 min, const vec3 max, int corner_index, vec3 corner)
+{
+  corner[0] = corner_index & 1 ? max[0] : min[0];
+  corner[1] = corner_index & 2 ? max[1] : min[1];
+  corner[2] = corner_index & 4 ? max[2] : min[2];
+}
+
+// Skinned positions are blends of the positions transformed by each of their joints, so they always stay within the
+// boxes around the vertices of each joint in bind space, once those are transformed by the joint as well. The points
+// are either added to the box of the bounds or to the radius around its center.
+static void add_skinned_boxes(OutputBounds* bounds,
+                              const vec3* joint_mins,
+                              const vec3* joint_maxs,
+                              const bool* is_joint_used,
+                              const mat4* skinning_matrices,
+                              uint32_t joint_count,
+                              uint32_t pose_count,
+                              bool add_to_radius)
+{
+  for (uint32_t pose_index = 0; pose_index < pose_count; ++pose_index)
+  {
+    for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+    {
+      if (!is_joint_used[joint_index])
+      {
+        continue;
+      }
+
+      for (int corner_index = 0; corner_index < 8; ++corner_index)
+      {
+        vec3 corner;
+        get_box_corner(joint_mins[joint_index], joint_maxs[joint_index], corner_index, corner);
+        glm_mat4_mulv3((vec4*)skinning_matrices[pose_index * joint_count + joint_index], corner, 1.0f, corner);
+
+        if (add_to_radius)
+        {
+          bounds->radius = glm_max(bounds->radius, glm_vec3_distance(bounds->center, corner));
+        }
+        else
+        {
+          glm_vec3_minv(bounds->min, corner, bounds->min);
+          glm_vec3_maxv(bounds->max, corner, bounds->max);
+        }
+      }
+    }
+  }
+}
+
+void calculate_mesh_bounds(OutputMesh* output_mesh,
+                           const mat4* skinning_matrices,
+                           uint32_t joint_count,
+                           uint32_t pose_count)
+{
+  OutputBounds* bounds = &output_mesh->bounds;
+  if (output_mesh->vertex_count == 0)
+  {
+    glm_vec3_zero(bounds->min);
+    glm_vec3_zero(bounds->max);
+    glm_vec3_zero(bounds->center);
+    bounds->radius = 0.0f;
+    return;
+  }
+
+  init_bounds(bounds);
+
+  // Rest pose
+  for (uint64_t vertex_index = 0; vertex_index < output_mesh->vertex_count; ++vertex_index)
+  {
+    glm_vec3_minv(bounds->min, output_mesh->positions[vertex_index], bounds->min);
+    glm_vec3_maxv(bounds->max, output_mesh->positions[vertex_index], bounds->max);
+  }
+
+  // Boxes around the vertices of each joint that affects the mesh
+  vec3 *joint_mins = NULL, *joint_maxs = NULL;
+  bool* is_joint_used = NULL;
+  if (pose_count > 0)
+  {
+    joint_mins = malloc(sizeof(vec3) * joint_count);
+    joint_maxs = malloc(sizeof(vec3) * joint_count);
+    is_joint_used = calloc(joint_count, sizeof(bool));
+    assert(joint_mins && joint_maxs && is_joint_used);
+
+    for (uint64_t vertex_index = 0; vertex_index < output_mesh->vertex_count; ++vertex_index)
+    {
+      for (int influence = 0; influence < 4; ++influence)
+      {
+        const int32_t joint_index = output_mesh->joints[vertex_index][influence];
+        if (output_mesh->weights[vertex_index][influence] <= 0.0f || joint_index < 0 ||
+            (uint32_t)joint_index >= joint_count)
+        {
+          continue;
+        }
+
+        if (!is_joint_used[joint_index])
+        {
+          is_joint_used[joint_index] = true;
+          glm_vec3_copy(output_mesh->positions[vertex_index], joint_mins[joint_index]);
+          glm_vec3_copy(output_mesh->positions[vertex_index], joint_maxs[joint_index]);
+        }
+
+        glm_vec3_minv(joint_mins[joint_index], output_mesh->positions[vertex_index], joint_mins[joint_index]);
+        glm_vec3_maxv(joint_maxs[joint_index], output_mesh->positions[vertex_index], joint_maxs[joint_index]);
+      }
+    }
+
+    add_skinned_boxes(bounds, joint_mins, joint_maxs, is_joint_used, skinning_matrices, joint_count, pose_count,
+                      false);
+  }
+
+  // The sphere around the center of the box is usually a lot tighter than the one around the box itself
+  glm_vec3_center(bounds->min, bounds->max, bounds->center);
+  for (uint64_t vertex_index = 0; vertex_index < output_mesh->vertex_count; ++vertex_index)
+  {
+    bounds->radius = glm_max(bounds->radius, glm_vec3_distance(bounds->center, output_mesh->positions[vertex_index]));
+  }
+
+  if (pose_count > 0)
+  {
+    add_skinned_boxes(bounds, joint_mins, joint_maxs, is_joint_used, skinning_matrices, joint_count, pose_count,
+                      true);
+
+    free(joint_mins);
+    free(joint_maxs);
+    free(is_joint_used);
+  }
+}
+
+void calculate_model_bounds(const OutputMesh* output_meshes, uint64_t mesh_count, OutputBounds* bounds)
+{
+  init_bounds(bounds);
+
+  for (uint64_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+  {
+    const OutputBounds* mesh_bounds = &output_meshes[mesh_index].bounds;
+    glm_vec3_minv(bounds->min, (float*)mesh_bounds->min, bounds->min);
+    glm_vec3_maxv(bounds->max, (float*)mesh_bounds->max, bounds->max);
+  }
+
+  if (mesh_count == 0)
+  {
+    glm_vec3_zero(bounds->min);
+    glm_vec3_zero(bounds->max);
+  }
+
+  // Either the sphere around the box or the one around all mesh spheres, whichever is tighter
+  glm_vec3_center(bounds->min, bounds->max, bounds->center);
+  float radius = 0.0f;
+  for (uint64_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+  {
+    const OutputBounds* mesh_bounds = &output_meshes[mesh_index].bounds;
+    radius = glm_max(radius, glm_vec3_distance(bounds->center, (float*)mesh_bounds->center) + mesh_bounds->radius);
+  }
+
+  bounds->radius = glm_min(radius, glm_vec3_distance(bounds->min, bounds->max) * 0.5f);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cglm/types.h>
+
+#include <stdint.h>
+
+typedef struct OutputBounds OutputBounds;
+typedef struct OutputMesh OutputMesh;
+
+// Fills in the bounds of the mesh, which cover its rest pose and, for skinned meshes, every one of the sampled poses.
+// The skinning matrices are laid out pose after pose and can be NULL without any poses.
+void calculate_mesh_bounds(OutputMesh* output_mesh,
+                           const mat4* skinning_matrices,
+                           uint32_t joint_count,
+                           uint32_t pose_count);
+
+// Bounds that contain the bounds of all meshes
+void calculate_model_bounds(const OutputMesh* output_meshes, uint64_t mesh_count, OutputBounds* bounds);
@@ -1,8 +1,14 @@
 #include "geometry_module.h"
 
+#include "bounds_calculator.h"
+#include "lod_generator.h"
 #include "mesh_inspector.h"
+#include "mesh_optimizer.h"
+#include "meshlet_generator.h"
 #include "output_mesh.h"
 #include "tangent_generator.h"
+#include "vertex_quantizer.h"
+#include "vertex_welder.h"
 
 #include "config.h"
 
@@ -27,6 +33,10 @@
 static cgltf_size output_mesh_count;
 static OutputMesh* output_meshes = NULL;
 
+static uint64_t index_buffer_size = 0; // In bytes
+
+static OutputBounds model_bounds;
+
 static void add_vertices_to_output_mesh(OutputMesh* output_mesh,
                                         cgltf_material* material,
                                         const cgltf_data* input_file,
@@ -184,6 +194,25 @@ static void add_vertices_to_output_mesh(OutputMesh* output_mesh,
   }
 }
 
+#ifdef OPTIMIZE_MESHES
+static void print_vertex_cache_statistics(const struct VertexCacheStatistics* original_statistics,
+                                          const struct VertexCacheStatistics* optimized_statistics)
+{
+  // Average cache miss ratio is per triangle, average transformed vertices per vertex, the ideal for both is 0.5 and 1
+  const double original_acmr =
+    (double)original_statistics->transformed_vertex_count / (double)original_statistics->triangle_count;
+  const double optimized_acmr =
+    (double)optimized_statistics->transformed_vertex_count / (double)optimized_statistics->triangle_count;
+  const double original_atvr =
+    (double)original_statistics->transformed_vertex_count / (double)original_statistics->vertex_count;
+  const double optimized_atvr =
+    (double)optimized_statistics->transformed_vertex_count / (double)optimized_statistics->vertex_count;
+
+  printf("Vertex cache optimization: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", original_acmr, optimized_acmr,
+         original_atvr, optimized_atvr);
+}
+#endif
+
 bool geo_is_primitive_valid(const cgltf_primitive* primitive)
 {
   cgltf_attribute *positions = NULL, *normals = NULL;
@@ -229,10 +258,14 @@ void geo_create(const cgltf_data* input_file)
     memset(output_meshes, 0, output_meshes_size);
   }
 
+#ifdef OPTIMIZE_MESHES
+  struct VertexCacheStatistics original_statistics = { 0 }, optimized_statistics = { 0 };
+#endif
+
   // Count the mesh vertices and indices and allocate space for them
   {
     cgltf_size output_mesh_index = 0;
-    cgltf_size first_mesh_vertex = 0, first_mesh_index = 0;
+    cgltf_size first_mesh_vertex = 0;
     for (cgltf_size node_index = 0; node_index < input_file->nodes_count; ++node_index)
     {
       cgltf_node* node = &input_file->nodes[node_index];
@@ -304,11 +337,33 @@ void geo_create(const cgltf_data* input_file)
 
           for (cgltf_size index = 0; index < primitive->indices->count; ++index)
           {
-            output_mesh->indices[index] = cgltf_accessor_read_index(primitive->indices, index) + first_mesh_vertex;
+            output_mesh->indices[index] = (uint32_t)cgltf_accessor_read_index(primitive->indices, index);
           }
         }
 
-        output_mesh->first_index = first_mesh_index;
+#ifdef WELD_VERTICES
+        weld_vertices(output_mesh);
+#endif
+
+#ifdef OPTIMIZE_MESHES
+        analyze_vertex_cache(output_mesh, &original_statistics);
+        optimize_mesh(output_mesh);
+#endif
+
+#ifdef GENERATE_MESHLETS
+        generate_meshlets(output_mesh);
+        optimize_vertex_fetch(output_mesh); // The meshlets have regrouped the triangles, LODs use the final vertices
+#endif
+
+#ifdef OPTIMIZE_MESHES
+        analyze_vertex_cache(output_mesh, &optimized_statistics); // Including the regrouping into meshlets
+#endif
+
+#ifdef GENERATE_LODS
+        generate_lods(output_mesh);
+#endif
+
+        output_mesh->first_vertex = first_mesh_vertex;
 
         // Material index
         if (primitive->material)
@@ -322,10 +377,56 @@ void geo_create(const cgltf_data* input_file)
 
         ++output_mesh_index;
         first_mesh_vertex += output_mesh->vertex_count;
-        first_mesh_index += output_mesh->index_count;
       }
     }
   }
+
+#ifdef OPTIMIZE_MESHES
+  print_vertex_cache_statistics(&original_statistics, &optimized_statistics);
+#endif
+
+  // Bounds of the meshes in their rest pose and every sampled pose of the animations, and of the whole model
+  {
+    uint32_t pose_count;
+    mat4* skinning_matrices = anim_calculate_sampled_skinning_matrices(&pose_count);
+
+    for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+    {
+      calculate_mesh_bounds(&output_meshes[mesh_index], skinning_matrices, anim_get_joint_count(), pose_count);
+    }
+
+    calculate_model_bounds(output_meshes, output_mesh_count, &model_bounds);
+
+    free(skinning_matrices);
+  }
+
+  // Pick the index type of each mesh and lay out the index buffer, keeping 32-bit indices aligned, with the LODs of
+  // each mesh right after it
+  index_buffer_size = 0;
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    OutputMesh* output_mesh = &output_meshes[mesh_index];
+
+    output_mesh->index_type = AEMIndexType_UInt32;
+#ifdef COMPACT_INDICES
+    if (output_mesh->vertex_count <= UINT16_MAX + 1)
+    {
+      output_mesh->index_type = AEMIndexType_UInt16;
+    }
+#endif
+
+    const uint32_t index_size = aem_get_index_size(output_mesh->index_type);
+    index_buffer_size = (index_buffer_size + index_size - 1) / index_size * index_size;
+    output_mesh->first_index = index_buffer_size / index_size;
+    index_buffer_size += output_mesh->index_count * index_size;
+
+    for (uint32_t lod_index = 0; lod_index < output_mesh->lod_count; ++lod_index)
+    {
+      OutputMeshLOD* lod = &output_mesh->lods[lod_index];
+      lod->first_index = index_buffer_size / index_size;
+      index_buffer_size += lod->index_count * index_size;
+    }
+  }
 }
 
 uint32_t geo_calculate_vertex_count()
@@ -346,19 +447,169 @@ uint32_t geo_calculate_index_count()
   for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
   {
     const OutputMesh* mesh = &output_meshes[mesh_index];
-    index_count += mesh->index_count;
+    index_count += mesh->index_count; // LOD indices are only described by the mesh LOD section
   }
 
   return index_count;
 }
 
+uint64_t geo_get_index_buffer_size()
+{
+  return index_buffer_size;
+}
+
 uint32_t geo_get_mesh_count()
 {
   return (uint32_t)output_mesh_count;
 }
 
+uint32_t geo_calculate_vertex_format()
+{
+  uint32_t vertex_format = 0;
+
+#ifdef SPLIT_VERTEX_STREAMS
+  vertex_format |= AEM_VERTEX_FORMAT_SPLIT_STREAMS;
+#endif
+
+#ifdef QUANTIZE_VERTICES
+  vertex_format |= AEM_VERTEX_FORMAT_QUANTIZED | AEM_VERTEX_FORMAT_UV_UNORM16;
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    const OutputMesh* output_mesh = &output_meshes[mesh_index];
+
+    for (cgltf_size vertex_index = 0; vertex_index < output_mesh->vertex_count; ++vertex_index)
+    {
+      // Unorm16 UVs are more precise than half-floats but they can't tile
+      const float* uv = output_mesh->uvs[vertex_index];
+      if (uv[0] < 0.0f || uv[0] > 1.0f || uv[1] < 0.0f || uv[1] > 1.0f)
+      {
+        vertex_format &= ~AEM_VERTEX_FORMAT_UV_UNORM16;
+      }
+
+      for (int i = 0; i < 4; ++i)
+      {
+        if (output_mesh->joints[vertex_index][i] > UINT8_MAX)
+        {
+          vertex_format |= AEM_VERTEX_FORMAT_JOINTS_UINT16;
+        }
+      }
+    }
+  }
+#endif
+
+  return vertex_format;
+}
+
+static void write_shading_attributes(const OutputMesh* output_mesh,
+                                    cgltf_size vertex_index,
+                                    uint32_t vertex_format,
+                                    FILE* output_file)
+{
+  if (!(vertex_format & AEM_VERTEX_FORMAT_QUANTIZED))
+  {
+    fwrite(output_mesh->normals[vertex_index], sizeof(output_mesh->normals[vertex_index]), 1, output_file);
+    fwrite(output_mesh->tangents[vertex_index], sizeof(output_mesh->tangents[vertex_index]), 1, output_file);
+    fwrite(output_mesh->bitangents[vertex_index], sizeof(output_mesh->bitangents[vertex_index]), 1, output_file);
+    fwrite(output_mesh->uvs[vertex_index], sizeof(output_mesh->uvs[vertex_index]), 1, output_file);
+    return;
+  }
+
+  // Normal
+  {
+    vec2 encoded_normal;
+    encode_octahedral(output_mesh->normals[vertex_index], encoded_normal);
+
+    const int16_t normal[2] = { quantize_snorm16(encoded_normal[0]), quantize_snorm16(encoded_normal[1]) };
+    fwrite(normal, sizeof(normal), 1, output_file);
+  }
+
+  // Tangent and the sign of the bitangent, which is otherwise reconstructed from the normal and tangent
+  {
+    vec3 tangent;
+    glm_vec3_normalize_to(output_mesh->tangents[vertex_index], tangent);
+
+    vec2 encoded_tangent;
+    encode_octahedral(tangent, encoded_tangent);
+
+    vec3 reconstructed_bitangent;
+    glm_vec3_cross(output_mesh->normals[vertex_index], tangent, reconstructed_bitangent);
+    const float bitangent_sign =
+      glm_vec3_dot(reconstructed_bitangent, output_mesh->bitangents[vertex_index]) < 0.0f ? -1.0f : 1.0f;
+
+    const int8_t tangent_and_sign[4] = { quantize_snorm8(encoded_tangent[0]), quantize_snorm8(encoded_tangent[1]),
+                                         quantize_snorm8(bitangent_sign), 0 };
+    fwrite(tangent_and_sign, sizeof(tangent_and_sign), 1, output_file);
+  }
+
+  // UV
+  {
+    const float* uv = output_mesh->uvs[vertex_index];
+
+    uint16_t quantized_uv[2];
+    if (vertex_format & AEM_VERTEX_FORMAT_UV_UNORM16)
+    {
+      quantized_uv[0] = quantize_unorm16(uv[0]);
+      quantized_uv[1] = quantize_unorm16(uv[1]);
+    }
+    else
+    {
+      quantized_uv[0] = quantize_half(uv[0]);
+      quantized_uv[1] = quantize_half(uv[1]);
+    }
+
+    fwrite(quantized_uv, sizeof(quantized_uv), 1, output_file);
+  }
+}
+
+static void write_skinning_attributes(const OutputMesh* output_mesh,
+                                     cgltf_size vertex_index,
+                                     uint32_t vertex_format,
+                                     FILE* output_file)
+{
+  if (!(vertex_format & AEM_VERTEX_FORMAT_QUANTIZED))
+  {
+    fwrite(output_mesh->joints[vertex_index], sizeof(output_mesh->joints[vertex_index]), 1, output_file);
+    fwrite(output_mesh->weights[vertex_index], sizeof(output_mesh->weights[vertex_index]), 1, output_file);
+    return;
+  }
+
+  // Joint indices, unused joints have a weight of 0 so they can safely point at the first joint
+  {
+    const int32_t* joints = output_mesh->joints[vertex_index];
+    if (vertex_format & AEM_VERTEX_FORMAT_JOINTS_UINT16)
+    {
+      uint16_t quantized_joints[4];
+      for (int i = 0; i < 4; ++i)
+      {
+        quantized_joints[i] = joints[i] >= 0 ? (uint16_t)joints[i] : 0;
+      }
+
+      fwrite(quantized_joints, sizeof(quantized_joints), 1, output_file);
+    }
+    else
+    {
+      uint8_t quantized_joints[4];
+      for (int i = 0; i < 4; ++i)
+      {
+        quantized_joints[i] = joints[i] >= 0 ? (uint8_t)joints[i] : 0;
+      }
+
+      fwrite(quantized_joints, sizeof(quantized_joints), 1, output_file);
+    }
+  }
+
+  // Joint weights
+  {
+    uint8_t quantized_weights[4];
+    quantize_weights(output_mesh->weights[vertex_index], quantized_weights);
+    fwrite(quantized_weights, sizeof(quantized_weights), 1, output_file);
+  }
+}
+
 void geo_write_vertex_buffer(FILE* output_file)
 {
+  const uint32_t vertex_format = geo_calculate_vertex_format();
+
   static uint32_t vertex_counter = 0;
   for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
   {
@@ -366,13 +617,17 @@ void geo_write_vertex_buffer(FILE* output_file)
 
     for (cgltf_size vertex_index = 0; vertex_index < output_mesh->vertex_count; ++vertex_index)
     {
-      fwrite(output_mesh->positions[vertex_index], sizeof(output_mesh->positions[vertex_index]), 1, output_file);
-      fwrite(output_mesh->normals[vertex_index], sizeof(output_mesh->normals[vertex_index]), 1, output_file);
-      fwrite(output_mesh->tangents[vertex_index], sizeof(output_mesh->tangents[vertex_index]), 1, output_file);
-      fwrite(output_mesh->bitangents[vertex_index], sizeof(output_mesh->bitangents[vertex_index]), 1, output_file);
-      fwrite(output_mesh->uvs[vertex_index], sizeof(output_mesh->uvs[vertex_index]), 1, output_file);
-      fwrite(output_mesh->joints[vertex_index], sizeof(output_mesh->joints[vertex_index]), 1, output_file);
-      fwrite(output_mesh->weights[vertex_index], sizeof(output_mesh->weights[vertex_index]), 1, output_file);
+      // Split vertex formats store positions and skinning data in the position buffer instead
+      if (vertex_format & AEM_VERTEX_FORMAT_SPLIT_STREAMS)
+      {
+        write_shading_attributes(output_mesh, vertex_index, vertex_format, output_file);
+      }
+      else
+      {
+        fwrite(output_mesh->positions[vertex_index], sizeof(output_mesh->positions[vertex_index]), 1, output_file);
+        write_shading_attributes(output_mesh, vertex_index, vertex_format, output_file);
+        write_skinning_attributes(output_mesh, vertex_index, vertex_format, output_file);
+      }
 
 #ifdef PRINT_VERTEX_BUFFER
       if (PRINT_VERTEX_BUFFER_COUNT == 0 || vertex_counter < PRINT_VERTEX_BUFFER_COUNT)
@@ -406,12 +661,63 @@ void geo_write_vertex_buffer(FILE* output_file)
   }
 }
 
+void geo_write_position_buffer(FILE* output_file)
+{
+  const uint32_t vertex_format = geo_calculate_vertex_format();
+  if (!(vertex_format & AEM_VERTEX_FORMAT_SPLIT_STREAMS))
+  {
+    return;
+  }
+
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    const OutputMesh* output_mesh = &output_meshes[mesh_index];
+
+    for (cgltf_size vertex_index = 0; vertex_index < output_mesh->vertex_count; ++vertex_index)
+    {
+      fwrite(output_mesh->positions[vertex_index], sizeof(output_mesh->positions[vertex_index]), 1, output_file);
+      write_skinning_attributes(output_mesh, vertex_index, vertex_format, output_file);
+    }
+  }
+}
+
+static void write_indices(const uint32_t* indices, uint64_t index_count, uint32_t index_type, FILE* output_file)
+{
+  if (index_type == AEMIndexType_UInt16)
+  {
+    for (uint64_t index = 0; index < index_count; ++index)
+    {
+      const uint16_t short_index = (uint16_t)indices[index];
+      fwrite(&short_index, sizeof(short_index), 1, output_file);
+    }
+  }
+  else
+  {
+    fwrite(indices, index_count * sizeof(*indices), 1, output_file);
+  }
+}
+
 void geo_write_index_buffer(FILE* output_file)
 {
+  uint64_t size = 0;
   for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
   {
     const OutputMesh* output_mesh = &output_meshes[mesh_index];
-    fwrite(output_mesh->indices, output_mesh->index_count * sizeof(*output_mesh->indices), 1, output_file);
+
+    // Pad up to the first index of the mesh
+    const uint32_t index_size = aem_get_index_size(output_mesh->index_type);
+    const uint8_t padding[4] = { 0 };
+    fwrite(padding, 1, output_mesh->first_index * index_size - size, output_file);
+
+    write_indices(output_mesh->indices, output_mesh->index_count, output_mesh->index_type, output_file);
+    size = (output_mesh->first_index + output_mesh->index_count) * index_size;
+
+    for (uint32_t lod_index = 0; lod_index < output_mesh->lod_count; ++lod_index)
+    {
+      const OutputMeshLOD* lod = &output_mesh->lods[lod_index];
+      write_indices(lod->indices, lod->index_count, output_mesh->index_type, output_file);
+      size = (lod->first_index + lod->index_count) * index_size;
+    }
   }
 }
 
@@ -430,11 +736,146 @@ void geo_write_meshes(FILE* output_file)
     const uint32_t material_index = output_mesh->material_index;
     fwrite(&material_index, sizeof(material_index), 1, output_file);
 
+    const uint32_t base_vertex = (uint32_t)output_mesh->first_vertex;
+    fwrite(&base_vertex, sizeof(base_vertex), 1, output_file);
+
+    const uint32_t index_type = output_mesh->index_type;
+    fwrite(&index_type, sizeof(index_type), 1, output_file);
+
 #ifdef PRINT_MESHES
     printf("Mesh #%llu \"%s\":\n", mesh_index, output_mesh->input_mesh->name);
     printf("\tFirst index: %u\n", first_index);
     printf("\tIndex count: %u\n", index_count);
     printf("\tMaterial index: %d\n", material_index);
+    printf("\tBase vertex: %u\n", base_vertex);
+    printf("\tIndex type: %s\n", index_type == AEMIndexType_UInt16 ? "16-bit" : "32-bit");
+#endif
+  }
+}
+
+void geo_write_mesh_lods(FILE* output_file)
+{
+  // Leave out the section entirely when no mesh has any LODs
+  uint32_t lod_count = 0;
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    lod_count += output_meshes[mesh_index].lod_count;
+  }
+
+  if (lod_count == 0)
+  {
+    return;
+  }
+
+  // The offset of the first LOD of each mesh, followed by the total LOD count
+  uint32_t lod_offset = 0;
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    fwrite(&lod_offset, sizeof(lod_offset), 1, output_file);
+    lod_offset += output_meshes[mesh_index].lod_count;
+  }
+  fwrite(&lod_offset, sizeof(lod_offset), 1, output_file);
+
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    const OutputMesh* output_mesh = &output_meshes[mesh_index];
+    for (uint32_t lod_index = 0; lod_index < output_mesh->lod_count; ++lod_index)
+    {
+      const OutputMeshLOD* lod = &output_mesh->lods[lod_index];
+
+      const uint32_t first_index = (uint32_t)lod->first_index;
+      fwrite(&first_index, sizeof(first_index), 1, output_file);
+
+      const uint32_t index_count = (uint32_t)lod->index_count;
+      fwrite(&index_count, sizeof(index_count), 1, output_file);
+
+      fwrite(&lod->error, sizeof(lod->error), 1, output_file);
+
+#ifdef PRINT_MESHES
+      printf("Mesh #%llu LOD #%u:\n", mesh_index, lod_index + 1);
+      printf("\tFirst index: %u\n", first_index);
+      printf("\tIndex count: %u\n", index_count);
+      printf("\tError: %f\n", lod->error);
+#endif
+    }
+  }
+}
+
+void geo_write_meshlets(FILE* output_file)
+{
+  // Leave out the section entirely when no mesh has any meshlets
+  uint32_t meshlet_count = 0;
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    meshlet_count += output_meshes[mesh_index].meshlet_count;
+  }
+
+  if (meshlet_count == 0)
+  {
+    return;
+  }
+
+  // The offset of the first meshlet of each mesh, followed by the total meshlet count
+  uint32_t meshlet_offset = 0;
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    fwrite(&meshlet_offset, sizeof(meshlet_offset), 1, output_file);
+    meshlet_offset += output_meshes[mesh_index].meshlet_count;
+  }
+  fwrite(&meshlet_offset, sizeof(meshlet_offset), 1, output_file);
+
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    const OutputMesh* output_mesh = &output_meshes[mesh_index];
+    for (uint32_t meshlet_index = 0; meshlet_index < output_mesh->meshlet_count; ++meshlet_index)
+    {
+      const OutputMeshlet* meshlet = &output_mesh->meshlets[meshlet_index];
+
+      const uint32_t first_index = (uint32_t)(output_mesh->first_index + meshlet->first_index);
+      fwrite(&first_index, sizeof(first_index), 1, output_file);
+
+      const uint32_t index_count = (uint32_t)meshlet->index_count;
+      fwrite(&index_count, sizeof(index_count), 1, output_file);
+
+      fwrite(meshlet->center, sizeof(meshlet->center), 1, output_file);
+      fwrite(&meshlet->radius, sizeof(meshlet->radius), 1, output_file);
+      fwrite(meshlet->cone_apex, sizeof(meshlet->cone_apex), 1, output_file);
+      fwrite(meshlet->cone_axis, sizeof(meshlet->cone_axis), 1, output_file);
+      fwrite(&meshlet->cone_cutoff, sizeof(meshlet->cone_cutoff), 1, output_file);
+    }
+
+#ifdef PRINT_MESHES
+    printf("Mesh #%llu meshlets: %u\n", mesh_index, output_mesh->meshlet_count);
+#endif
+  }
+}
+
+static void write_bounds(const OutputBounds* bounds, FILE* output_file)
+{
+  fwrite(bounds->min, sizeof(bounds->min), 1, output_file);
+  fwrite(bounds->max, sizeof(bounds->max), 1, output_file);
+  fwrite(bounds->center, sizeof(bounds->center), 1, output_file);
+  fwrite(&bounds->radius, sizeof(bounds->radius), 1, output_file);
+}
+
+void geo_write_bounds(FILE* output_file)
+{
+  // The bounds of the model come first, followed by those of each mesh
+  write_bounds(&model_bounds, output_file);
+
+#ifdef PRINT_MESHES
+  printf("Model bounds: [ %f, %f, %f ] - [ %f, %f, %f ], radius %f\n", model_bounds.min[0], model_bounds.min[1],
+         model_bounds.min[2], model_bounds.max[0], model_bounds.max[1], model_bounds.max[2], model_bounds.radius);
+#endif
+
+  for (cgltf_size mesh_index = 0; mesh_index < output_mesh_count; ++mesh_index)
+  {
+    const OutputBounds* bounds = &output_meshes[mesh_index].bounds;
+    write_bounds(bounds, output_file);
+
+#ifdef PRINT_MESHES
+    printf("Mesh #%llu bounds: [ %f, %f, %f ] - [ %f, %f, %f ], radius %f\n", mesh_index, bounds->min[0],
+           bounds->min[1], bounds->min[2], bounds->max[0], bounds->max[1], bounds->max[2], bounds->radius);
 #endif
   }
 }
@@ -452,6 +893,14 @@ void geo_free()
     free(output_mesh->uvs);
 
     free(output_mesh->indices);
+
+    for (uint32_t lod_index = 0; lod_index < output_mesh->lod_count; ++lod_index)
+    {
+      free(output_mesh->lods[lod_index].indices);
+    }
+    free(output_mesh->lods);
+
+    free(output_mesh->meshlets);
   }
 
   free(output_meshes);
@@ -13,11 +13,18 @@ void geo_create(const cgltf_data* input_file);
 
 uint32_t geo_calculate_vertex_count();
 uint32_t geo_calculate_index_count();
+uint64_t geo_get_index_buffer_size(); // In bytes
 
 uint32_t geo_get_mesh_count();
 
+uint32_t geo_calculate_vertex_format(); // Combination of AEM_VERTEX_FORMAT_* flags
+
 void geo_write_vertex_buffer(FILE* output_file);
+void geo_write_position_buffer(FILE* output_file); // Only writes data for split vertex formats
 void geo_write_index_buffer(FILE* output_file);
 void geo_write_meshes(FILE* output_file);
+void geo_write_mesh_lods(FILE* output_file); // Writes nothing if no mesh has LODs
+void geo_write_meshlets(FILE* output_file);  // Writes nothing if no mesh has meshlets
+void geo_write_bounds(FILE* output_file);
 
 void geo_free();
\ No newline at end of file
@@ -0,0 +1,479 @@
+#include "lod_generator.h"
+
+#include "mesh_optimizer.h"
+#include "output_mesh.h"
+
+#include "config.h"
+
+#include <cglm/vec3.h>
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_VERTEX UINT32_MAX
+
+// Squared distance to a set of planes, weighted by the area of the triangles that they came from
+struct Quadric
+{
+  double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+  double area;
+};
+
+static void add_triangle_quadric(struct Quadric* quadric, const float* p0, const float* p1, const float* p2)
+{
+  vec3 edge1, edge2, normal;
+  glm_vec3_sub((float*)p1, (float*)p0, edge1);
+  glm_vec3_sub((float*)p2, (float*)p0, edge2);
+  glm_vec3_cross(edge1, edge2, normal);
+
+  const float length = glm_vec3_norm(normal);
+  if (length <= 0.0f)
+  {
+    return;
+  }
+
+  const double area = length * 0.5;
+  const double a = normal[0] / length, b = normal[1] / length, c = normal[2] / length;
+  const double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+
+  quadric->a2 += area * a * a;
+  quadric->ab += area * a * b;
+  quadric->ac += area * a * c;
+  quadric->ad += area * a * d;
+  quadric->b2 += area * b * b;
+  quadric->bc += area * b * c;
+  quadric->bd += area * b * d;
+  quadric->c2 += area * c * c;
+  quadric->cd += area * c * d;
+  quadric->d2 += area * d * d;
+  quadric->area += area;
+}
+
+static void add_quadric(struct Quadric* quadric, const struct Quadric* other)
+{
+  quadric->a2 += other->a2;
+  quadric->ab += other->ab;
+  quadric->ac += other->ac;
+  quadric->ad += other->ad;
+  quadric->b2 += other->b2;
+  quadric->bc += other->bc;
+  quadric->bd += other->bd;
+  quadric->c2 += other->c2;
+  quadric->cd += other->cd;
+  quadric->d2 += other->d2;
+  quadric->area += other->area;
+}
+
+// Average squared distance of the point to the planes of both quadrics
+static double evaluate_quadrics(const struct Quadric* q0, const struct Quadric* q1, const float* point)
+{
+  struct Quadric q = *q0;
+  add_quadric(&q, q1);
+
+  const double x = point[0], y = point[1], z = point[2];
+  const double error = q.a2 * x * x + 2.0 * q.ab * x * y + 2.0 * q.ac * x * z + 2.0 * q.ad * x + q.b2 * y * y +
+                       2.0 * q.bc * y * z + 2.0 * q.bd * y + q.c2 * z * z + 2.0 * q.cd * z + q.d2;
+  return q.area > 0.0 ? fabs(error) / q.area : 0.0;
+}
+
+// Maps every vertex to the first vertex with the same position, so that vertices split by seams stay together
+static void find_position_twins(const OutputMesh* output_mesh, uint32_t* position_ids)
+{
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+
+  uint32_t slot_count = 1;
+  while (slot_count < vertex_count * 2)
+  {
+    slot_count *= 2;
+  }
+
+  uint32_t* slots = malloc(sizeof(uint32_t) * slot_count);
+  assert(slots);
+  memset(slots, 0xff, sizeof(uint32_t) * slot_count);
+
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    uint32_t bits[3];
+    memcpy(bits, output_mesh->positions[vertex_index], sizeof(bits));
+
+    uint32_t slot = (bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u) & (slot_count - 1);
+    while (slots[slot] != NO_VERTEX &&
+           memcmp(output_mesh->positions[slots[slot]], output_mesh->positions[vertex_index], sizeof(vec3)))
+    {
+      slot = (slot + 1) & (slot_count - 1);
+    }
+
+    if (slots[slot] == NO_VERTEX)
+    {
+      slots[slot] = vertex_index;
+    }
+
+    position_ids[vertex_index] = slots[slot];
+  }
+
+  free(slots);
+}
+
+// Vertices on open borders and on attribute seams can't be moved without tearing the mesh or smearing its attributes
+static void find_locked_vertices(const OutputMesh* output_mesh, const uint32_t* position_ids, bool* is_locked)
+{
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+  const uint32_t index_count = (uint32_t)output_mesh->index_count;
+
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    is_locked[vertex_index] = false;
+  }
+
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    if (position_ids[vertex_index] != vertex_index)
+    {
+      is_locked[vertex_index] = is_locked[position_ids[vertex_index]] = true;
+    }
+  }
+
+  // An edge is on a border if no triangle uses it in the opposite direction
+  uint32_t slot_count = 1;
+  while (slot_count < index_count * 2)
+  {
+    slot_count *= 2;
+  }
+
+  uint64_t* edges = malloc(sizeof(uint64_t) * slot_count);
+  assert(edges);
+  memset(edges, 0xff, sizeof(uint64_t) * slot_count);
+
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    for (uint32_t index = 0; index < index_count; ++index)
+    {
+      const uint32_t from = position_ids[output_mesh->indices[index]];
+      const uint32_t to = position_ids[output_mesh->indices[index - index % 3 + (index + 1) % 3]];
+
+      // Insert the edges in the first pass and look for their opposites in the second
+      const uint64_t edge = pass == 0 ? (uint64_t)from << 32 | to : (uint64_t)to << 32 | from;
+      uint32_t slot = (uint32_t)((edge * 0x9E3779B97F4A7C15ull) >> 32) & (slot_count - 1);
+      while (edges[slot] != UINT64_MAX && edges[slot] != edge)
+      {
+        slot = (slot + 1) & (slot_count - 1);
+      }
+
+      if (pass == 0)
+      {
+        edges[slot] = edge;
+      }
+      else if (edges[slot] == UINT64_MAX)
+      {
+        is_locked[from] = is_locked[to] = true;
+      }
+    }
+  }
+
+  free(edges);
+
+  // Twins of locked positions are already locked themselves
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    is_locked[vertex_index] = is_locked[vertex_index] || is_locked[position_ids[vertex_index]];
+  }
+}
+
+struct Collapse
+{
+  uint32_t from, to;
+  double error;
+};
+
+static int compare_collapses(const void* a, const void* b)
+{
+  const double error_a = ((const struct Collapse*)a)->error;
+  const double error_b = ((const struct Collapse*)b)->error;
+  return error_a < error_b ? -1 : error_a > error_b ? 1 : 0;
+}
+
+// Whether moving a vertex onto another one keeps all of its remaining triangles facing the same way
+static bool is_collapse_flipping(const OutputMesh* output_mesh,
+                                 const uint32_t* indices,
+                                 const uint32_t* triangle_offsets,
+                                 const uint32_t* triangles,
+                                 uint32_t from,
+                                 uint32_t to)
+{
+  for (uint32_t offset = triangle_offsets[from]; offset < triangle_offsets[from + 1]; ++offset)
+  {
+    const uint32_t* triangle = &indices[triangles[offset] * 3];
+    if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+    {
+      continue; // Removed by the collapse
+    }
+
+    vec3 p[3], moved[3];
+    for (int corner = 0; corner < 3; ++corner)
+    {
+      glm_vec3_copy(output_mesh->positions[triangle[corner]], p[corner]);
+      glm_vec3_copy(output_mesh->positions[triangle[corner] == from ? to : triangle[corner]], moved[corner]);
+    }
+
+    vec3 edge1, edge2, normal, moved_normal;
+    glm_vec3_sub(p[1], p[0], edge1);
+    glm_vec3_sub(p[2], p[0], edge2);
+    glm_vec3_cross(edge1, edge2, normal);
+    glm_vec3_sub(moved[1], moved[0], edge1);
+    glm_vec3_sub(moved[2], moved[0], edge2);
+    glm_vec3_cross(edge1, edge2, moved_normal);
+
+    if (glm_vec3_dot(normal, moved_normal) <= 0.0f)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Collapses edges in passes of independent collapses with the lowest errors until the target or the maximum error is
+// reached. Vertices are always collapsed onto a neighbor, so no new vertices are needed. Returns the new index count.
+static uint32_t simplify(const OutputMesh* output_mesh,
+                         const uint32_t* position_ids,
+                         const bool* is_locked,
+                         uint32_t* indices, // In and out
+                         uint32_t index_count,
+                         uint32_t target_index_count,
+                         float max_error,
+                         float* error)
+{
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+
+  // Quadrics are shared by all vertices at the same position
+  struct Quadric* quadrics = calloc(vertex_count, sizeof(struct Quadric));
+  uint32_t* triangle_offsets = malloc(sizeof(uint32_t) * (vertex_count + 1));
+  uint32_t* triangles = malloc(sizeof(uint32_t) * index_count);
+  struct Collapse* collapses = malloc(sizeof(struct Collapse) * vertex_count);
+  uint32_t* remap = malloc(sizeof(uint32_t) * vertex_count);
+  bool* is_touched = malloc(sizeof(bool) * vertex_count);
+  assert(quadrics && triangle_offsets && triangles && collapses && remap && is_touched);
+
+  for (uint32_t index = 0; index < index_count; index += 3)
+  {
+    const uint32_t* triangle = &indices[index];
+    struct Quadric triangle_quadric = { 0 };
+    add_triangle_quadric(&triangle_quadric, output_mesh->positions[triangle[0]], output_mesh->positions[triangle[1]],
+                         output_mesh->positions[triangle[2]]);
+
+    for (int corner = 0; corner < 3; ++corner)
+    {
+      add_quadric(&quadrics[position_ids[triangle[corner]]], &triangle_quadric);
+    }
+  }
+
+  const double max_squared_error = (double)max_error * max_error;
+  double largest_error = 0.0;
+  while (index_count > target_index_count)
+  {
+    // Find the triangles around each vertex
+    memset(triangle_offsets, 0, sizeof(uint32_t) * (vertex_count + 1));
+    for (uint32_t index = 0; index < index_count; ++index)
+    {
+      ++triangle_offsets[indices[index] + 1];
+    }
+
+    for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+    {
+      triangle_offsets[vertex_index + 1] += triangle_offsets[vertex_index];
+    }
+
+    for (uint32_t index = 0; index < index_count; ++index)
+    {
+      triangles[triangle_offsets[indices[index]]++] = index / 3;
+    }
+
+    for (uint32_t vertex_index = vertex_count; vertex_index > 0; --vertex_index)
+    {
+      triangle_offsets[vertex_index] = triangle_offsets[vertex_index - 1];
+    }
+    triangle_offsets[0] = 0;
+
+    // The cheapest collapse of every vertex that can move
+    uint32_t collapse_count = 0;
+    for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+    {
+      if (is_locked[vertex_index])
+      {
+        continue;
+      }
+
+      struct Collapse best_collapse = { vertex_index, NO_VERTEX, DBL_MAX };
+      for (uint32_t offset = triangle_offsets[vertex_index]; offset < triangle_offsets[vertex_index + 1]; ++offset)
+      {
+        const uint32_t* triangle = &indices[triangles[offset] * 3];
+        for (int corner = 0; corner < 3; ++corner)
+        {
+          const uint32_t to = triangle[corner];
+          if (to == vertex_index)
+          {
+            continue;
+          }
+
+          const double collapse_error = evaluate_quadrics(&quadrics[position_ids[vertex_index]],
+                                                          &quadrics[position_ids[to]], output_mesh->positions[to]);
+          if (collapse_error < best_collapse.error)
+          {
+            best_collapse.to = to;
+            best_collapse.error = collapse_error;
+          }
+        }
+      }
+
+      if (best_collapse.to != NO_VERTEX && best_collapse.error <= max_squared_error)
+      {
+        collapses[collapse_count++] = best_collapse;
+      }
+    }
+
+    qsort(collapses, collapse_count, sizeof(struct Collapse), compare_collapses);
+
+    // Perform as many collapses as possible that don't touch the neighborhood of another collapse in this pass
+    for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+    {
+      remap[vertex_index] = vertex_index;
+      is_touched[vertex_index] = false;
+    }
+
+    uint32_t remaining_index_count = index_count;
+    uint32_t performed_collapse_count = 0;
+    for (uint32_t collapse_index = 0; collapse_index < collapse_count && remaining_index_count > target_index_count;
+         ++collapse_index)
+    {
+      const struct Collapse* collapse = &collapses[collapse_index];
+      if (is_touched[collapse->from] || is_touched[collapse->to] ||
+          is_collapse_flipping(output_mesh, indices, triangle_offsets, triangles, collapse->from, collapse->to))
+      {
+        continue;
+      }
+
+      for (uint32_t offset = triangle_offsets[collapse->from]; offset < triangle_offsets[collapse->from + 1]; ++offset)
+      {
+        const uint32_t* triangle = &indices[triangles[offset] * 3];
+        for (int corner = 0; corner < 3; ++corner)
+        {
+          is_touched[triangle[corner]] = true;
+        }
+
+        if (triangle[0] == collapse->to || triangle[1] == collapse->to || triangle[2] == collapse->to)
+        {
+          remaining_index_count -= 3;
+        }
+      }
+
+      remap[collapse->from] = collapse->to;
+      add_quadric(&quadrics[position_ids[collapse->to]], &quadrics[position_ids[collapse->from]]);
+      largest_error = fmax(largest_error, collapse->error);
+      ++performed_collapse_count;
+    }
+
+    if (performed_collapse_count == 0)
+    {
+      break;
+    }
+
+    // Apply the collapses and drop the triangles that collapsed with them
+    uint32_t new_index_count = 0;
+    for (uint32_t index = 0; index < index_count; index += 3)
+    {
+      const uint32_t a = remap[indices[index + 0]], b = remap[indices[index + 1]], c = remap[indices[index + 2]];
+      if (a != b && b != c && c != a)
+      {
+        indices[new_index_count++] = a;
+        indices[new_index_count++] = b;
+        indices[new_index_count++] = c;
+      }
+    }
+
+    index_count = new_index_count;
+  }
+
+  *error = (float)sqrt(largest_error);
+
+  free(quadrics);
+  free(triangle_offsets);
+  free(triangles);
+  free(collapses);
+  free(remap);
+  free(is_touched);
+
+  return index_count;
+}
+
+void generate_lods(OutputMesh* output_mesh)
+{
+  const float lod_ratios[] = LOD_RATIOS;
+  const uint32_t max_lod_count = sizeof(lod_ratios) / sizeof(lod_ratios[0]);
+
+  output_mesh->lods = malloc(sizeof(*output_mesh->lods) * max_lod_count);
+  assert(output_mesh->lods);
+  output_mesh->lod_count = 0;
+
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+  const uint32_t index_count = (uint32_t)output_mesh->index_count;
+  if (vertex_count == 0 || index_count == 0)
+  {
+    return;
+  }
+
+  // The error budget scales with the size of the mesh
+  vec3 min, max;
+  glm_vec3_copy(output_mesh->positions[0], min);
+  glm_vec3_copy(output_mesh->positions[0], max);
+  for (uint32_t vertex_index = 1; vertex_index < vertex_count; ++vertex_index)
+  {
+    glm_vec3_minv(min, output_mesh->positions[vertex_index], min);
+    glm_vec3_maxv(max, output_mesh->positions[vertex_index], max);
+  }
+  const float max_error = glm_vec3_distance(min, max) * LOD_ERROR_BUDGET;
+
+  uint32_t* position_ids = malloc(sizeof(uint32_t) * vertex_count);
+  bool* is_locked = malloc(sizeof(bool) * vertex_count);
+  assert(position_ids && is_locked);
+
+  find_position_twins(output_mesh, position_ids);
+  find_locked_vertices(output_mesh, position_ids, is_locked);
+
+  // Every LOD is simplified from the full mesh, so that its error is measured against the original surface
+  uint32_t previous_index_count = index_count;
+  for (uint32_t lod_index = 0; lod_index < max_lod_count; ++lod_index)
+  {
+    const uint32_t target_index_count = (uint32_t)(index_count / 3 * lod_ratios[lod_index]) * 3;
+
+    uint32_t* indices = malloc(sizeof(uint32_t) * index_count);
+    assert(indices);
+    memcpy(indices, output_mesh->indices, sizeof(uint32_t) * index_count);
+
+    float error;
+    const uint32_t lod_index_count = simplify(output_mesh, position_ids, is_locked, indices, index_count,
+                                              target_index_count, max_error, &error);
+
+    // Stop once a LOD doesn't save enough over the previous one to be worth it
+    if (lod_index_count == 0 || lod_index_count > previous_index_count * LOD_MIN_REDUCTION)
+    {
+      free(indices);
+      break;
+    }
+
+    optimize_triangle_order(output_mesh, indices, lod_index_count);
+
+    OutputMeshLOD* lod = &output_mesh->lods[output_mesh->lod_count++];
+    lod->indices = indices;
+    lod->index_count = lod_index_count;
+    lod->error = error;
+
+    previous_index_count = lod_index_count;
+  }
+
+  free(position_ids);
+  free(is_locked);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+typedef struct OutputMesh OutputMesh;
+
+// Fills in the LODs of the mesh by simplifying it to the target ratios in config.h, until the error budget is used up
+// or the mesh can't be simplified any further. The LODs use the vertices of the mesh, they only have their own indices.
+void generate_lods(OutputMesh* output_mesh);
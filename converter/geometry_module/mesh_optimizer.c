@@ -0,0 +1,459 @@
+#include "mesh_optimizer.h"
+
+#include "output_mesh.h"
+
+#include "config.h"
+
+#include <cglm/vec3.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_VERTEX UINT32_MAX
+
+// A first-in-first-out cache of transformed vertices, as most hardware has
+struct VertexCache
+{
+  uint32_t* timestamps; // When each vertex was last transformed, in transformed vertices
+  uint32_t time;
+};
+
+static void init_vertex_cache(struct VertexCache* cache, uint64_t vertex_count)
+{
+  cache->timestamps = malloc(sizeof(uint32_t) * vertex_count);
+  assert(cache->timestamps);
+  cache->time = 0;
+
+  // Start out of reach of the cache so that every vertex misses the first time
+  for (uint64_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    cache->timestamps[vertex_index] = UINT32_MAX - VERTEX_CACHE_SIZE;
+  }
+}
+
+static void reset_vertex_cache(struct VertexCache* cache)
+{
+  cache->time += VERTEX_CACHE_SIZE;
+}
+
+// Returns the number of vertices of the triangle that had to be transformed
+static uint32_t add_triangle_to_vertex_cache(struct VertexCache* cache, const uint32_t* triangle)
+{
+  uint32_t miss_count = 0;
+  for (int corner = 0; corner < 3; ++corner)
+  {
+    if (cache->time - cache->timestamps[triangle[corner]] > VERTEX_CACHE_SIZE)
+    {
+      cache->timestamps[triangle[corner]] = cache->time++;
+      ++miss_count;
+    }
+  }
+
+  return miss_count;
+}
+
+void analyze_vertex_cache(const OutputMesh* output_mesh, struct VertexCacheStatistics* statistics)
+{
+  struct VertexCache cache;
+  init_vertex_cache(&cache, output_mesh->vertex_count);
+
+  for (uint64_t index = 0; index + 2 < output_mesh->index_count; index += 3)
+  {
+    statistics->transformed_vertex_count += add_triangle_to_vertex_cache(&cache, &output_mesh->indices[index]);
+  }
+
+  statistics->triangle_count += output_mesh->index_count / 3;
+  statistics->vertex_count += output_mesh->vertex_count;
+
+  free(cache.timestamps);
+}
+
+// The triangles that use each vertex
+struct VertexAdjacency
+{
+  uint32_t* offsets; // Into the triangles, one more than there are vertices
+  uint32_t* triangles;
+};
+
+static void build_vertex_adjacency(const uint32_t* indices,
+                                   uint32_t triangle_count,
+                                   uint32_t vertex_count,
+                                   struct VertexAdjacency* adjacency)
+{
+  adjacency->offsets = calloc(vertex_count + 1, sizeof(uint32_t));
+  adjacency->triangles = malloc(sizeof(uint32_t) * triangle_count * 3);
+  uint32_t* fill_offsets = malloc(sizeof(uint32_t) * vertex_count);
+  assert(adjacency->offsets && adjacency->triangles && fill_offsets);
+
+  for (uint32_t index = 0; index < triangle_count * 3; ++index)
+  {
+    ++adjacency->offsets[indices[index] + 1];
+  }
+
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    adjacency->offsets[vertex_index + 1] += adjacency->offsets[vertex_index];
+    fill_offsets[vertex_index] = adjacency->offsets[vertex_index];
+  }
+
+  for (uint32_t index = 0; index < triangle_count * 3; ++index)
+  {
+    adjacency->triangles[fill_offsets[indices[index]]++] = index / 3;
+  }
+
+  free(fill_offsets);
+}
+
+// Returns the next vertex with triangles left, first from the most recently used vertices and then in index order
+static uint32_t skip_dead_end(const uint32_t* live_triangle_counts,
+                              uint32_t vertex_count,
+                              const uint32_t* dead_ends,
+                              uint32_t* dead_end_count,
+                              uint32_t* next_vertex_index)
+{
+  while (*dead_end_count > 0)
+  {
+    const uint32_t vertex_index = dead_ends[--*dead_end_count];
+    if (live_triangle_counts[vertex_index] > 0)
+    {
+      return vertex_index;
+    }
+  }
+
+  for (; *next_vertex_index < vertex_count; ++*next_vertex_index)
+  {
+    if (live_triangle_counts[*next_vertex_index] > 0)
+    {
+      return *next_vertex_index;
+    }
+  }
+
+  return NO_VERTEX;
+}
+
+// Tipsify from "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" by Sander, Nehab and Barczak. Fans
+// around a vertex at a time and moves on to a neighbor that is still in the cache. Whenever there is none, the order
+// has to jump to another part of the mesh, which starts a new cluster.
+static void optimize_vertex_cache(const uint32_t* indices,
+                                  uint32_t triangle_count,
+                                  uint32_t vertex_count,
+                                  uint32_t* optimized_indices,
+                                  bool* cluster_starts) // One per triangle
+{
+  struct VertexAdjacency adjacency;
+  build_vertex_adjacency(indices, triangle_count, vertex_count, &adjacency);
+
+  uint32_t* live_triangle_counts = malloc(sizeof(uint32_t) * vertex_count);
+  uint32_t* timestamps = calloc(vertex_count, sizeof(uint32_t));
+  uint32_t* dead_ends = malloc(sizeof(uint32_t) * triangle_count * 3);
+  uint32_t* candidates = malloc(sizeof(uint32_t) * triangle_count * 3);
+  bool* is_emitted = calloc(triangle_count, sizeof(bool));
+  assert(live_triangle_counts && timestamps && dead_ends && candidates && is_emitted);
+
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    live_triangle_counts[vertex_index] = adjacency.offsets[vertex_index + 1] - adjacency.offsets[vertex_index];
+  }
+
+  uint32_t time = VERTEX_CACHE_SIZE + 1; // So that no vertex starts out in the cache
+  uint32_t dead_end_count = 0, next_vertex_index = 0, triangle_index = 0;
+  uint32_t fanning_vertex =
+    skip_dead_end(live_triangle_counts, vertex_count, dead_ends, &dead_end_count, &next_vertex_index);
+  bool is_new_cluster = true;
+  while (fanning_vertex != NO_VERTEX)
+  {
+    // Emit all remaining triangles around the fanning vertex
+    uint32_t candidate_count = 0;
+    for (uint32_t offset = adjacency.offsets[fanning_vertex]; offset < adjacency.offsets[fanning_vertex + 1]; ++offset)
+    {
+      const uint32_t triangle = adjacency.triangles[offset];
+      if (is_emitted[triangle])
+      {
+        continue;
+      }
+
+      for (int corner = 0; corner < 3; ++corner)
+      {
+        const uint32_t vertex_index = indices[triangle * 3 + corner];
+        optimized_indices[triangle_index * 3 + corner] = vertex_index;
+        dead_ends[dead_end_count++] = vertex_index;
+        candidates[candidate_count++] = vertex_index;
+        --live_triangle_counts[vertex_index];
+
+        if (time - timestamps[vertex_index] > VERTEX_CACHE_SIZE)
+        {
+          timestamps[vertex_index] = time++;
+        }
+      }
+
+      cluster_starts[triangle_index++] = is_new_cluster;
+      is_new_cluster = false;
+      is_emitted[triangle] = true;
+    }
+
+    // Prefer the candidate that entered the cache the earliest and that will still be in it after fanning around it,
+    // candidates that have left the cache are never picked so that a dead end starts a new cluster instead
+    uint32_t next_vertex = NO_VERTEX;
+    int64_t best_priority = 0;
+    for (uint32_t candidate_index = 0; candidate_index < candidate_count; ++candidate_index)
+    {
+      const uint32_t vertex_index = candidates[candidate_index];
+      if (live_triangle_counts[vertex_index] == 0)
+      {
+        continue;
+      }
+
+      int64_t priority = 0;
+      const int64_t age = time - timestamps[vertex_index];
+      if (age + 2 * (int64_t)live_triangle_counts[vertex_index] <= VERTEX_CACHE_SIZE)
+      {
+        priority = age;
+      }
+
+      if (priority > best_priority)
+      {
+        best_priority = priority;
+        next_vertex = vertex_index;
+      }
+    }
+
+    if (next_vertex == NO_VERTEX)
+    {
+      next_vertex = skip_dead_end(live_triangle_counts, vertex_count, dead_ends, &dead_end_count, &next_vertex_index);
+      is_new_cluster = true;
+    }
+
+    fanning_vertex = next_vertex;
+  }
+
+  assert(triangle_index == triangle_count);
+
+  free(adjacency.offsets);
+  free(adjacency.triangles);
+  free(live_triangle_counts);
+  free(timestamps);
+  free(dead_ends);
+  free(candidates);
+  free(is_emitted);
+}
+
+struct Cluster
+{
+  uint32_t first_triangle, triangle_count;
+  float sort_key; // How much the cluster faces away from the center of the mesh
+};
+
+static int compare_clusters(const void* a, const void* b)
+{
+  const struct Cluster* cluster_a = (const struct Cluster*)a;
+  const struct Cluster* cluster_b = (const struct Cluster*)b;
+
+  if (cluster_a->sort_key != cluster_b->sort_key)
+  {
+    return cluster_a->sort_key > cluster_b->sort_key ? -1 : 1;
+  }
+
+  // Keep the cache friendly order for ties
+  return cluster_a->first_triangle < cluster_b->first_triangle ? -1 : 1;
+}
+
+// Sums up the area-weighted centroid and the area-weighted normal of a range of triangles
+static float accumulate_triangles(const OutputMesh* output_mesh,
+                                  const uint32_t* indices,
+                                  uint32_t first_triangle,
+                                  uint32_t triangle_count,
+                                  vec3 centroid,
+                                  vec3 normal)
+{
+  float area = 0.0f;
+  for (uint32_t triangle = first_triangle; triangle < first_triangle + triangle_count; ++triangle)
+  {
+    const float* p0 = output_mesh->positions[indices[triangle * 3 + 0]];
+    const float* p1 = output_mesh->positions[indices[triangle * 3 + 1]];
+    const float* p2 = output_mesh->positions[indices[triangle * 3 + 2]];
+
+    vec3 edge1, edge2, cross;
+    glm_vec3_sub((float*)p1, (float*)p0, edge1);
+    glm_vec3_sub((float*)p2, (float*)p0, edge2);
+    glm_vec3_cross(edge1, edge2, cross);
+    const float triangle_area = glm_vec3_norm(cross) * 0.5f;
+
+    vec3 triangle_centroid;
+    glm_vec3_add((float*)p0, (float*)p1, triangle_centroid);
+    glm_vec3_add(triangle_centroid, (float*)p2, triangle_centroid);
+    glm_vec3_muladds(triangle_centroid, triangle_area / 3.0f, centroid);
+
+    glm_vec3_add(normal, cross, normal);
+    area += triangle_area;
+  }
+
+  return area;
+}
+
+// The overdraw part of Tipsify. Clusters are split up further wherever that keeps the cache miss ratio within the
+// overdraw threshold, then clusters that face outwards are drawn first so that they occlude the ones behind them.
+static void optimize_overdraw(const OutputMesh* output_mesh,
+                              uint32_t* indices,
+                              uint32_t triangle_count,
+                              uint32_t vertex_count,
+                              const bool* cluster_starts)
+{
+  struct VertexCache cache;
+  init_vertex_cache(&cache, vertex_count);
+
+  uint64_t transformed_vertex_count = 0;
+  for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+  {
+    transformed_vertex_count += add_triangle_to_vertex_cache(&cache, &indices[triangle * 3]);
+  }
+
+  const float threshold = (float)transformed_vertex_count / (float)triangle_count * OVERDRAW_THRESHOLD;
+
+  struct Cluster* clusters = malloc(sizeof(struct Cluster) * triangle_count);
+  assert(clusters);
+
+  uint32_t cluster_count = 0;
+  uint32_t cluster_transformed_vertex_count = 0;
+  for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+  {
+    if (cluster_starts[triangle] || cluster_transformed_vertex_count == 0)
+    {
+      reset_vertex_cache(&cache);
+      clusters[cluster_count++] = (struct Cluster){ triangle, 0, 0.0f };
+      cluster_transformed_vertex_count = 0;
+    }
+
+    struct Cluster* cluster = &clusters[cluster_count - 1];
+    cluster_transformed_vertex_count += add_triangle_to_vertex_cache(&cache, &indices[triangle * 3]);
+    ++cluster->triangle_count;
+
+    // Soft boundary, the next triangle starts a new cluster with a cold cache
+    if ((float)cluster_transformed_vertex_count / (float)cluster->triangle_count <= threshold)
+    {
+      cluster_transformed_vertex_count = 0;
+    }
+  }
+
+  vec3 mesh_centroid = GLM_VEC3_ZERO_INIT, mesh_normal = GLM_VEC3_ZERO_INIT;
+  const float mesh_area = accumulate_triangles(output_mesh, indices, 0, triangle_count, mesh_centroid, mesh_normal);
+  glm_vec3_scale(mesh_centroid, mesh_area > 0.0f ? 1.0f / mesh_area : 0.0f, mesh_centroid);
+
+  for (uint32_t cluster_index = 0; cluster_index < cluster_count; ++cluster_index)
+  {
+    struct Cluster* cluster = &clusters[cluster_index];
+
+    vec3 centroid = GLM_VEC3_ZERO_INIT, normal = GLM_VEC3_ZERO_INIT;
+    const float area =
+      accumulate_triangles(output_mesh, indices, cluster->first_triangle, cluster->triangle_count, centroid, normal);
+    glm_vec3_scale(centroid, area > 0.0f ? 1.0f / area : 0.0f, centroid);
+    glm_vec3_normalize(normal);
+
+    vec3 offset;
+    glm_vec3_sub(centroid, mesh_centroid, offset);
+    cluster->sort_key = glm_vec3_dot(offset, normal);
+  }
+
+  qsort(clusters, cluster_count, sizeof(struct Cluster), compare_clusters);
+
+  uint32_t* sorted_indices = malloc(sizeof(uint32_t) * triangle_count * 3);
+  assert(sorted_indices);
+
+  uint32_t* destination = sorted_indices;
+  for (uint32_t cluster_index = 0; cluster_index < cluster_count; ++cluster_index)
+  {
+    const struct Cluster* cluster = &clusters[cluster_index];
+    memcpy(destination, &indices[cluster->first_triangle * 3], sizeof(uint32_t) * cluster->triangle_count * 3);
+    destination += cluster->triangle_count * 3;
+  }
+
+  memcpy(indices, sorted_indices, sizeof(uint32_t) * triangle_count * 3);
+
+  free(sorted_indices);
+  free(clusters);
+  free(cache.timestamps);
+}
+
+static void reorder_attribute(void* attribute, size_t attribute_size, const uint32_t* order, uint32_t count)
+{
+  uint8_t* reordered = malloc(attribute_size * count);
+  assert(reordered);
+
+  for (uint32_t index = 0; index < count; ++index)
+  {
+    memcpy(&reordered[index * attribute_size], (uint8_t*)attribute + order[index] * attribute_size, attribute_size);
+  }
+
+  memcpy(attribute, reordered, attribute_size * count);
+  free(reordered);
+}
+
+void optimize_vertex_fetch(OutputMesh* output_mesh)
+{
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+
+  uint32_t* remap = malloc(sizeof(uint32_t) * vertex_count);
+  uint32_t* order = malloc(sizeof(uint32_t) * vertex_count); // Old vertex for each new one
+  assert(remap && order);
+
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    remap[vertex_index] = NO_VERTEX;
+  }
+
+  uint32_t used_vertex_count = 0;
+  for (uint64_t index = 0; index < output_mesh->index_count; ++index)
+  {
+    const uint32_t vertex_index = output_mesh->indices[index];
+    if (remap[vertex_index] == NO_VERTEX)
+    {
+      order[used_vertex_count] = vertex_index;
+      remap[vertex_index] = used_vertex_count++;
+    }
+
+    output_mesh->indices[index] = remap[vertex_index];
+  }
+
+  reorder_attribute(output_mesh->positions, sizeof(*output_mesh->positions), order, used_vertex_count);
+  reorder_attribute(output_mesh->normals, sizeof(*output_mesh->normals), order, used_vertex_count);
+  reorder_attribute(output_mesh->tangents, sizeof(*output_mesh->tangents), order, used_vertex_count);
+  reorder_attribute(output_mesh->bitangents, sizeof(*output_mesh->bitangents), order, used_vertex_count);
+  reorder_attribute(output_mesh->uvs, sizeof(*output_mesh->uvs), order, used_vertex_count);
+  reorder_attribute(output_mesh->joints, sizeof(*output_mesh->joints), order, used_vertex_count);
+  reorder_attribute(output_mesh->weights, sizeof(*output_mesh->weights), order, used_vertex_count);
+
+  output_mesh->vertex_count = used_vertex_count;
+
+  free(remap);
+  free(order);
+}
+
+void optimize_triangle_order(const OutputMesh* output_mesh, uint32_t* indices, uint64_t index_count)
+{
+  assert(index_count % 3 == 0);
+
+  const uint32_t triangle_count = (uint32_t)(index_count / 3);
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+  if (triangle_count == 0)
+  {
+    return;
+  }
+
+  uint32_t* optimized_indices = malloc(sizeof(uint32_t) * triangle_count * 3);
+  bool* cluster_starts = malloc(sizeof(bool) * triangle_count);
+  assert(optimized_indices && cluster_starts);
+
+  optimize_vertex_cache(indices, triangle_count, vertex_count, optimized_indices, cluster_starts);
+  optimize_overdraw(output_mesh, optimized_indices, triangle_count, vertex_count, cluster_starts);
+  memcpy(indices, optimized_indices, sizeof(uint32_t) * triangle_count * 3);
+
+  free(optimized_indices);
+  free(cluster_starts);
+}
+
+void optimize_mesh(OutputMesh* output_mesh)
+{
+  optimize_triangle_order(output_mesh, output_mesh->indices, output_mesh->index_count);
+  optimize_vertex_fetch(output_mesh);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct OutputMesh OutputMesh;
+
+struct VertexCacheStatistics
+{
+  uint64_t transformed_vertex_count; // Misses of the simulated post-transform vertex cache
+  uint64_t triangle_count, vertex_count;
+};
+
+// Simulates the post-transform vertex cache over the triangles of the mesh, adding to the statistics so that the
+// average cache miss ratio (transformed vertices per triangle) and the average transformed vertices per vertex of
+// several meshes can be reported together
+void analyze_vertex_cache(const OutputMesh* output_mesh, struct VertexCacheStatistics* statistics);
+
+// Reorders the triangles of indices that use the vertices of the mesh, like those of a LOD, the same way as
+// optimize_mesh() without touching the vertices themselves
+void optimize_triangle_order(const OutputMesh* output_mesh, uint32_t* indices, uint64_t index_count);
+
+// Renumbers the vertices in the order that the triangles first use them, which also drops unused vertices. Call it
+// again after anything that reorders the triangles of an optimized mesh.
+void optimize_vertex_fetch(OutputMesh* output_mesh);
+
+// Reorders the triangles for the post-transform vertex cache and then reorders clusters of them to draw those facing
+// outwards first, which reduces overdraw. Finally the vertices are reordered in the order that they are first used,
+// which also drops unused vertices.
+void optimize_mesh(OutputMesh* output_mesh);
@@ -0,0 +1,323 @@
+#include "meshlet_generator.h"
+
+#include "mesh_optimizer.h"
+#include "output_mesh.h"
+
+#include "config.h"
+
+#include <cglm/vec3.h>
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_TRIANGLE UINT32_MAX
+
+// Below this the normals of a meshlet spread out too far for the cone to ever cull it
+#define MIN_CONE_SPREAD 0.1f
+
+struct MeshletBuilder
+{
+  uint32_t vertices[MESHLET_MAX_VERTEX_COUNT];
+  uint32_t vertex_count, triangle_count;
+  vec3 normal_sum; // Of the unit normals of the triangles so far, as a rough cone axis
+};
+
+static void calculate_triangle_normal(const OutputMesh* output_mesh, const uint32_t* triangle, vec3 normal)
+{
+  vec3 edge1, edge2;
+  glm_vec3_sub(output_mesh->positions[triangle[1]], output_mesh->positions[triangle[0]], edge1);
+  glm_vec3_sub(output_mesh->positions[triangle[2]], output_mesh->positions[triangle[0]], edge2);
+  glm_vec3_cross(edge1, edge2, normal);
+  glm_vec3_normalize(normal); // Leaves degenerate triangles at zero
+}
+
+// How many vertices a triangle would add to the meshlet
+static uint32_t count_new_vertices(const uint32_t* triangle, const uint32_t* vertex_meshlets, uint32_t meshlet_index)
+{
+  return (vertex_meshlets[triangle[0]] != meshlet_index) + (vertex_meshlets[triangle[1]] != meshlet_index) +
+         (vertex_meshlets[triangle[2]] != meshlet_index);
+}
+
+// Picks the triangle next to the meshlet that adds the fewest vertices, faces the most like it and lies the closest to
+// its center, so that meshlets stay round and their normal cones narrow
+static uint32_t find_next_triangle(const OutputMesh* output_mesh,
+                                   const struct MeshletBuilder* builder,
+                                   const uint32_t* triangle_offsets,
+                                   const uint32_t* triangles,
+                                   const bool* is_emitted,
+                                   const uint32_t* vertex_meshlets,
+                                   uint32_t meshlet_index)
+{
+  vec3 axis;
+  glm_vec3_normalize_to((float*)builder->normal_sum, axis);
+
+  vec3 center = GLM_VEC3_ZERO_INIT;
+  for (uint32_t vertex = 0; vertex < builder->vertex_count; ++vertex)
+  {
+    glm_vec3_add(center, output_mesh->positions[builder->vertices[vertex]], center);
+  }
+  glm_vec3_divs(center, (float)glm_max(builder->vertex_count, 1), center);
+
+  float radius = 0.0f;
+  for (uint32_t vertex = 0; vertex < builder->vertex_count; ++vertex)
+  {
+    radius = glm_max(radius, glm_vec3_distance(center, output_mesh->positions[builder->vertices[vertex]]));
+  }
+
+  uint32_t best_triangle = NO_TRIANGLE;
+  float best_score = FLT_MAX;
+  for (uint32_t vertex = 0; vertex < builder->vertex_count; ++vertex)
+  {
+    const uint32_t vertex_index = builder->vertices[vertex];
+    for (uint32_t offset = triangle_offsets[vertex_index]; offset < triangle_offsets[vertex_index + 1]; ++offset)
+    {
+      const uint32_t triangle_index = triangles[offset];
+      if (is_emitted[triangle_index])
+      {
+        continue;
+      }
+
+      const uint32_t* triangle = &output_mesh->indices[triangle_index * 3];
+      const uint32_t new_vertex_count = count_new_vertices(triangle, vertex_meshlets, meshlet_index);
+      if (builder->vertex_count + new_vertex_count > MESHLET_MAX_VERTEX_COUNT)
+      {
+        continue;
+      }
+
+      vec3 normal, triangle_center;
+      calculate_triangle_normal(output_mesh, triangle, normal);
+      glm_vec3_add(output_mesh->positions[triangle[0]], output_mesh->positions[triangle[1]], triangle_center);
+      glm_vec3_add(triangle_center, output_mesh->positions[triangle[2]], triangle_center);
+      glm_vec3_scale(triangle_center, 1.0f / 3.0f, triangle_center);
+
+      const float distance = radius > 0.0f ? glm_vec3_distance(center, triangle_center) / radius : 0.0f;
+      const float score = (float)new_vertex_count + (1.0f - glm_vec3_dot(normal, axis)) * 0.5f + distance * 0.5f;
+      if (score < best_score)
+      {
+        best_triangle = triangle_index;
+        best_score = score;
+      }
+    }
+  }
+
+  return best_triangle;
+}
+
+// Growing meshlets by adjacency loses the vertex cache order of the mesh, so the triangles of each meshlet are
+// optimized again on their own, with the few vertices of the meshlet standing in for the mesh
+static void optimize_meshlet(const OutputMesh* output_mesh,
+                             const struct MeshletBuilder* builder,
+                             const uint32_t* local_vertices,
+                             uint32_t* indices,
+                             uint64_t index_count)
+{
+  vec3 positions[MESHLET_MAX_VERTEX_COUNT];
+  for (uint32_t vertex = 0; vertex < builder->vertex_count; ++vertex)
+  {
+    glm_vec3_copy(output_mesh->positions[builder->vertices[vertex]], positions[vertex]);
+  }
+
+  OutputMesh meshlet_mesh = { .positions = positions, .vertex_count = builder->vertex_count };
+
+  for (uint64_t index = 0; index < index_count; ++index)
+  {
+    indices[index] = local_vertices[indices[index]];
+  }
+
+  optimize_triangle_order(&meshlet_mesh, indices, index_count);
+
+  for (uint64_t index = 0; index < index_count; ++index)
+  {
+    indices[index] = builder->vertices[indices[index]];
+  }
+}
+
+static void calculate_meshlet_bounds(const OutputMesh* output_mesh,
+                                     const struct MeshletBuilder* builder,
+                                     const uint32_t* indices,
+                                     OutputMeshlet* meshlet)
+{
+  // Bounding sphere around the center of the bounding box
+  vec3 min, max;
+  glm_vec3_copy(output_mesh->positions[builder->vertices[0]], min);
+  glm_vec3_copy(output_mesh->positions[builder->vertices[0]], max);
+  for (uint32_t vertex = 1; vertex < builder->vertex_count; ++vertex)
+  {
+    glm_vec3_minv(min, output_mesh->positions[builder->vertices[vertex]], min);
+    glm_vec3_maxv(max, output_mesh->positions[builder->vertices[vertex]], max);
+  }
+
+  glm_vec3_center(min, max, meshlet->center);
+  meshlet->radius = 0.0f;
+  for (uint32_t vertex = 0; vertex < builder->vertex_count; ++vertex)
+  {
+    const float distance = glm_vec3_distance(meshlet->center, output_mesh->positions[builder->vertices[vertex]]);
+    meshlet->radius = glm_max(meshlet->radius, distance);
+  }
+
+  // Normal cone that contains the normals of all triangles
+  glm_vec3_normalize_to((float*)builder->normal_sum, meshlet->cone_axis);
+
+  float min_dot = 1.0f;
+  for (uint64_t index = 0; index < meshlet->index_count; index += 3)
+  {
+    vec3 normal;
+    calculate_triangle_normal(output_mesh, &indices[index], normal);
+    if (glm_vec3_norm2(normal) > 0.0f)
+    {
+      min_dot = glm_min(min_dot, glm_vec3_dot(normal, meshlet->cone_axis));
+    }
+  }
+
+  if (min_dot < MIN_CONE_SPREAD || glm_vec3_norm2(meshlet->cone_axis) == 0.0f)
+  {
+    glm_vec3_zero(meshlet->cone_axis);
+    glm_vec3_copy(meshlet->center, meshlet->cone_apex);
+    meshlet->cone_cutoff = 1.0f;
+    return;
+  }
+
+  // Move the apex back along the axis until it is behind the planes of all triangles, so that the cone test holds up
+  // under perspective as well
+  float apex_distance = 0.0f;
+  for (uint64_t index = 0; index < meshlet->index_count; index += 3)
+  {
+    vec3 normal, to_center;
+    calculate_triangle_normal(output_mesh, &indices[index], normal);
+
+    const float normal_dot = glm_vec3_dot(normal, meshlet->cone_axis);
+    if (normal_dot > 0.0f)
+    {
+      glm_vec3_sub(meshlet->center, output_mesh->positions[indices[index]], to_center);
+      apex_distance = glm_max(apex_distance, glm_vec3_dot(to_center, normal) / normal_dot);
+    }
+  }
+
+  glm_vec3_scale(meshlet->cone_axis, -apex_distance, meshlet->cone_apex);
+  glm_vec3_add(meshlet->center, meshlet->cone_apex, meshlet->cone_apex);
+  meshlet->cone_cutoff = sqrtf(1.0f - min_dot * min_dot);
+}
+
+void generate_meshlets(OutputMesh* output_mesh)
+{
+  output_mesh->meshlets = NULL;
+  output_mesh->meshlet_count = 0;
+
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+  const uint32_t triangle_count = (uint32_t)(output_mesh->index_count / 3);
+  if (triangle_count == 0)
+  {
+    return;
+  }
+
+  // Every triangle may end up in a meshlet of its own in the worst case
+  output_mesh->meshlets = malloc(sizeof(*output_mesh->meshlets) * triangle_count);
+  uint32_t* indices = malloc(sizeof(uint32_t) * triangle_count * 3);
+  uint32_t* triangle_offsets = calloc(vertex_count + 1, sizeof(uint32_t));
+  uint32_t* triangles = malloc(sizeof(uint32_t) * triangle_count * 3);
+  uint32_t* vertex_meshlets = malloc(sizeof(uint32_t) * vertex_count); // Last meshlet that each vertex was added to
+  uint32_t* local_vertices = malloc(sizeof(uint32_t) * vertex_count);  // Index of each vertex within that meshlet
+  bool* is_emitted = calloc(triangle_count, sizeof(bool));
+  assert(output_mesh->meshlets && indices && triangle_offsets && triangles && vertex_meshlets && local_vertices &&
+         is_emitted);
+
+  // Find the triangles around each vertex
+  for (uint32_t index = 0; index < triangle_count * 3; ++index)
+  {
+    ++triangle_offsets[output_mesh->indices[index] + 1];
+  }
+
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    triangle_offsets[vertex_index + 1] += triangle_offsets[vertex_index];
+    vertex_meshlets[vertex_index] = UINT32_MAX;
+  }
+
+  for (uint32_t index = 0; index < triangle_count * 3; ++index)
+  {
+    triangles[triangle_offsets[output_mesh->indices[index]]++] = index / 3;
+  }
+
+  for (uint32_t vertex_index = vertex_count; vertex_index > 0; --vertex_index)
+  {
+    triangle_offsets[vertex_index] = triangle_offsets[vertex_index - 1];
+  }
+  triangle_offsets[0] = 0;
+
+  // Grow one meshlet at a time, starting each from the first triangle left in the current order, which keeps the
+  // optimized order of the mesh intact at the meshlet level
+  uint32_t index_count = 0, seed_triangle = 0;
+  while (index_count < triangle_count * 3)
+  {
+    const uint32_t meshlet_index = output_mesh->meshlet_count++;
+    OutputMeshlet* meshlet = &output_mesh->meshlets[meshlet_index];
+    meshlet->first_index = index_count;
+
+    struct MeshletBuilder builder = { .vertex_count = 0, .triangle_count = 0 };
+    glm_vec3_zero(builder.normal_sum);
+
+    while (builder.triangle_count < MESHLET_MAX_TRIANGLE_COUNT)
+    {
+      uint32_t triangle_index = find_next_triangle(output_mesh, &builder, triangle_offsets, triangles, is_emitted,
+                                                   vertex_meshlets, meshlet_index);
+
+      // Continue with the next triangle in order when nothing around the meshlet fits anymore
+      if (triangle_index == NO_TRIANGLE)
+      {
+        while (seed_triangle < triangle_count && is_emitted[seed_triangle])
+        {
+          ++seed_triangle;
+        }
+
+        if (seed_triangle == triangle_count || builder.vertex_count + count_new_vertices(
+                                                 &output_mesh->indices[seed_triangle * 3], vertex_meshlets,
+                                                 meshlet_index) > MESHLET_MAX_VERTEX_COUNT)
+        {
+          break;
+        }
+
+        triangle_index = seed_triangle;
+      }
+
+      const uint32_t* triangle = &output_mesh->indices[triangle_index * 3];
+      for (int corner = 0; corner < 3; ++corner)
+      {
+        if (vertex_meshlets[triangle[corner]] != meshlet_index)
+        {
+          vertex_meshlets[triangle[corner]] = meshlet_index;
+          local_vertices[triangle[corner]] = builder.vertex_count;
+          builder.vertices[builder.vertex_count++] = triangle[corner];
+        }
+
+        indices[index_count++] = triangle[corner];
+      }
+
+      vec3 normal;
+      calculate_triangle_normal(output_mesh, triangle, normal);
+      glm_vec3_add(builder.normal_sum, normal, builder.normal_sum);
+
+      is_emitted[triangle_index] = true;
+      ++builder.triangle_count;
+    }
+
+    meshlet->index_count = index_count - meshlet->first_index;
+    optimize_meshlet(output_mesh, &builder, local_vertices, &indices[meshlet->first_index], meshlet->index_count);
+    calculate_meshlet_bounds(output_mesh, &builder, &indices[meshlet->first_index], meshlet);
+  }
+
+  memcpy(output_mesh->indices, indices, sizeof(uint32_t) * triangle_count * 3);
+
+  output_mesh->meshlets = realloc(output_mesh->meshlets, sizeof(*output_mesh->meshlets) * output_mesh->meshlet_count);
+  assert(output_mesh->meshlets);
+
+  free(indices);
+  free(triangle_offsets);
+  free(triangles);
+  free(vertex_meshlets);
+  free(local_vertices);
+  free(is_emitted);
+}
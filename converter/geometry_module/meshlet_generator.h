@@ -0,0 +1,8 @@
+#pragma once
+
+typedef struct OutputMesh OutputMesh;
+
+// Splits the mesh into meshlets of connected triangles within the vertex and triangle limits in config.h and gives
+// each of them a bounding sphere and a normal cone to cull it with. The triangles of the mesh are regrouped so that
+// every meshlet is a contiguous range of its indices.
+void generate_meshlets(OutputMesh* output_mesh);
@@ -6,6 +6,42 @@
 
 typedef struct cgltf_mesh cgltf_mesh;
 
+// Axis-aligned bounding box and bounding sphere in model space
+struct OutputBounds
+{
+  vec3 min, max;
+  vec3 center;
+  float radius;
+};
+
+typedef struct OutputBounds OutputBounds;
+
+// A simplified version of a mesh that draws a subset of its vertices with its own indices
+struct OutputMeshLOD
+{
+  uint32_t* indices; // Relative to the first vertex of the mesh
+
+  uint64_t index_count;
+  uint64_t first_index; // In indices of the index type of the mesh
+  float error;          // In model units
+};
+
+typedef struct OutputMeshLOD OutputMeshLOD;
+
+// A cluster of connected triangles that is small enough to be culled on its own
+struct OutputMeshlet
+{
+  uint64_t first_index, index_count; // Relative to the indices of the mesh
+
+  vec3 center; // Bounding sphere
+  float radius;
+
+  vec3 cone_apex, cone_axis; // Normal cone, the axis is zero if the cone can't cull anything
+  float cone_cutoff;
+};
+
+typedef struct OutputMeshlet OutputMeshlet;
+
 struct OutputMesh
 {
   cgltf_mesh* input_mesh;
@@ -15,10 +51,20 @@ struct OutputMesh
   ivec4* joints;
   vec4* weights;
 
-  uint32_t* indices;
+  uint32_t* indices; // Relative to the first vertex of the mesh
 
-  uint64_t vertex_count, index_count, first_index;
+  uint64_t vertex_count, index_count, first_vertex;
+  uint64_t first_index; // In indices of the index type of the mesh
+  uint32_t index_type;  // enum AEMIndexType
   uint32_t material_index;
+
+  OutputBounds bounds; // Of the rest pose and every sampled pose of the animations
+
+  OutputMeshLOD* lods; // From fine to coarse, without the mesh itself
+  uint32_t lod_count;
+
+  OutputMeshlet* meshlets; // Cover the indices of the mesh in order
+  uint32_t meshlet_count;
 };
 
 typedef struct OutputMesh OutputMesh;
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "vertex_quantizer.h"
+
+#include <math.h>
+#include <string.h>
+
+static float sign_not_zero(float value)
+{
+  return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+void encode_octahedral(const vec3 v, vec2 encoded)
+{
+  // Project onto the octahedron and then onto the plane, the lower hemisphere is folded over the diagonals
+  const float l1_norm = fabsf(v[0]) + fabsf(v[1]) + fabsf(v[2]);
+  const float x = v[0] / l1_norm;
+  const float y = v[1] / l1_norm;
+
+  if (v[2] >= 0.0f)
+  {
+    encoded[0] = x;
+    encoded[1] = y;
+  }
+  else
+  {
+    encoded[0] = (1.0f - fabsf(y)) * sign_not_zero(x);
+    encoded[1] = (1.0f - fabsf(x)) * sign_not_zero(y);
+  }
+}
+
+int16_t quantize_snorm16(float value)
+{
+  value = fminf(fmaxf(value, -1.0f), 1.0f);
+  return (int16_t)roundf(value * 32767.0f);
+}
+
+int8_t quantize_snorm8(float value)
+{
+  value = fminf(fmaxf(value, -1.0f), 1.0f);
+  return (int8_t)roundf(value * 127.0f);
+}
+
+uint16_t quantize_unorm16(float value)
+{
+  value = fminf(fmaxf(value, 0.0f), 1.0f);
+  return (uint16_t)roundf(value * 65535.0f);
+}
+
+uint16_t quantize_half(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+
+  const uint16_t sign = (bits >> 16) & 0x8000;
+  const int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+  uint32_t mantissa = bits & 0x7fffff;
+
+  // NaN and infinity
+  if (((bits >> 23) & 0xff) == 0xff)
+  {
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+  }
+
+  // Overflow to infinity
+  if (exponent >= 31)
+  {
+    return sign | 0x7c00;
+  }
+
+  // Subnormal or zero
+  if (exponent <= 0)
+  {
+    if (exponent < -10)
+    {
+      return sign;
+    }
+
+    mantissa |= 0x800000;
+    const uint32_t shift = (uint32_t)(14 - exponent);
+    uint16_t half = (uint16_t)(mantissa >> shift);
+
+    // Round to nearest even
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1)))
+    {
+      ++half;
+    }
+
+    return sign | half;
+  }
+
+  uint16_t half = (uint16_t)(((uint32_t)exponent << 10) | (mantissa >> 13));
+
+  // Round to nearest even, a carry into the exponent is still correct
+  const uint32_t remainder = mantissa & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+  {
+    ++half;
+  }
+
+  return sign | half;
+}
+
+void quantize_weights(const vec4 weights, uint8_t quantized_weights[4])
+{
+  const float weight_sum = weights[0] + weights[1] + weights[2] + weights[3];
+  if (weight_sum <= 0.0f)
+  {
+    memset(quantized_weights, 0, 4);
+    return;
+  }
+
+  // Round each weight and hand the rounding error to the largest one so that the sum stays exactly 255
+  int32_t quantized_sum = 0, largest_index = 0;
+  for (int32_t i = 0; i < 4; ++i)
+  {
+    quantized_weights[i] = (uint8_t)roundf(fmaxf(weights[i], 0.0f) / weight_sum * 255.0f);
+    quantized_sum += quantized_weights[i];
+
+    if (weights[i] > weights[largest_index])
+    {
+      largest_index = i;
+    }
+  }
+
+  quantized_weights[largest_index] = (uint8_t)(quantized_weights[largest_index] + 255 - quantized_sum);
+}
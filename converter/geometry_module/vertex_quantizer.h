@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cglm/types.h>
+
+#include <stdint.h>
+
+void encode_octahedral(const vec3 v, vec2 encoded); // Expects a normalized vector, results are in [-1, 1]
+
+int16_t quantize_snorm16(float value);
+int8_t quantize_snorm8(float value);
+uint16_t quantize_unorm16(float value);
+uint16_t quantize_half(float value);
+
+void quantize_weights(const vec4 weights, uint8_t quantized_weights[4]); // Quantized weights still add up to 1
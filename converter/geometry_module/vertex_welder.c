@@ -0,0 +1,179 @@
+#include "vertex_welder.h"
+
+#include "output_mesh.h"
+
+#include "config.h"
+
+#include <cglm/ivec4.h>
+#include <cglm/vec2.h>
+#include <cglm/vec3.h>
+#include <cglm/vec4.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_VERTEX UINT32_MAX
+
+// Vertices are looked up by the grid cell that their position falls into
+struct Cell
+{
+  int64_t coordinates[3];
+  uint32_t first_vertex; // Of the welded vertices in this cell, NO_VERTEX for empty slots
+};
+
+static int64_t get_cell_coordinate(float value)
+{
+  if (WELD_POSITION_EPSILON > 0.0f)
+  {
+    return (int64_t)floorf(value / WELD_POSITION_EPSILON);
+  }
+
+  // Without an epsilon only identical positions share a cell
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static uint64_t hash_cell(const int64_t coordinates[3])
+{
+  uint64_t hash = (uint64_t)coordinates[0] * 0x9E3779B97F4A7C15ull;
+  hash ^= (uint64_t)coordinates[1] * 0xC2B2AE3D27D4EB4Full;
+  hash ^= (uint64_t)coordinates[2] * 0x165667B19E3779F9ull;
+  return hash ^ (hash >> 32);
+}
+
+// Returns the slot of the cell, which is empty if the cell has not been added yet
+static struct Cell* find_cell(struct Cell* cells, uint64_t cell_count, const int64_t coordinates[3])
+{
+  // Linear probing, the table is never more than half full
+  uint64_t slot = hash_cell(coordinates) & (cell_count - 1);
+  while (cells[slot].first_vertex != NO_VERTEX && memcmp(cells[slot].coordinates, coordinates, sizeof(int64_t) * 3))
+  {
+    slot = (slot + 1) & (cell_count - 1);
+  }
+
+  return &cells[slot];
+}
+
+static bool are_floats_within(const float* a, const float* b, int count, float epsilon)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    if (fabsf(a[i] - b[i]) > epsilon)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool can_weld_vertices(const OutputMesh* output_mesh, uint32_t a, uint32_t b)
+{
+  return are_floats_within(output_mesh->positions[a], output_mesh->positions[b], 3, WELD_POSITION_EPSILON) &&
+         are_floats_within(output_mesh->normals[a], output_mesh->normals[b], 3, WELD_NORMAL_EPSILON) &&
+         are_floats_within(output_mesh->tangents[a], output_mesh->tangents[b], 3, WELD_NORMAL_EPSILON) &&
+         are_floats_within(output_mesh->bitangents[a], output_mesh->bitangents[b], 3, WELD_NORMAL_EPSILON) &&
+         are_floats_within(output_mesh->uvs[a], output_mesh->uvs[b], 2, WELD_UV_EPSILON) &&
+         !memcmp(output_mesh->joints[a], output_mesh->joints[b], sizeof(ivec4)) &&
+         are_floats_within(output_mesh->weights[a], output_mesh->weights[b], 4, WELD_WEIGHT_EPSILON);
+}
+
+static void move_vertex(OutputMesh* output_mesh, uint32_t from, uint32_t to)
+{
+  glm_vec3_copy(output_mesh->positions[from], output_mesh->positions[to]);
+  glm_vec3_copy(output_mesh->normals[from], output_mesh->normals[to]);
+  glm_vec3_copy(output_mesh->tangents[from], output_mesh->tangents[to]);
+  glm_vec3_copy(output_mesh->bitangents[from], output_mesh->bitangents[to]);
+  glm_vec2_copy(output_mesh->uvs[from], output_mesh->uvs[to]);
+  glm_ivec4_copy(output_mesh->joints[from], output_mesh->joints[to]);
+  glm_vec4_copy(output_mesh->weights[from], output_mesh->weights[to]);
+}
+
+void weld_vertices(OutputMesh* output_mesh)
+{
+  const uint32_t vertex_count = (uint32_t)output_mesh->vertex_count;
+  if (vertex_count == 0)
+  {
+    return;
+  }
+
+  uint64_t cell_count = 1;
+  while (cell_count < (uint64_t)vertex_count * 2)
+  {
+    cell_count *= 2;
+  }
+
+  struct Cell* cells = malloc(sizeof(struct Cell) * cell_count);
+  uint32_t* next_vertices = malloc(sizeof(uint32_t) * vertex_count); // Chains the welded vertices of a cell
+  uint32_t* remap = malloc(sizeof(uint32_t) * vertex_count);
+  assert(cells && next_vertices && remap);
+
+  for (uint64_t cell_index = 0; cell_index < cell_count; ++cell_index)
+  {
+    cells[cell_index].first_vertex = NO_VERTEX;
+  }
+
+  // Welded vertices are compacted to the front, which never overwrites a vertex that has not been visited yet
+  const int neighbor_range = WELD_POSITION_EPSILON > 0.0f ? 1 : 0;
+  uint32_t welded_vertex_count = 0;
+  for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+  {
+    int64_t coordinates[3];
+    for (int i = 0; i < 3; ++i)
+    {
+      coordinates[i] = get_cell_coordinate(output_mesh->positions[vertex_index][i]);
+    }
+
+    // A vertex within the epsilon can be in a neighboring cell
+    uint32_t match = NO_VERTEX;
+    for (int x = -neighbor_range; x <= neighbor_range && match == NO_VERTEX; ++x)
+    {
+      for (int y = -neighbor_range; y <= neighbor_range && match == NO_VERTEX; ++y)
+      {
+        for (int z = -neighbor_range; z <= neighbor_range && match == NO_VERTEX; ++z)
+        {
+          const int64_t neighbor[3] = { coordinates[0] + x, coordinates[1] + y, coordinates[2] + z };
+          for (uint32_t welded_vertex = find_cell(cells, cell_count, neighbor)->first_vertex;
+               welded_vertex != NO_VERTEX; welded_vertex = next_vertices[welded_vertex])
+          {
+            if (can_weld_vertices(output_mesh, welded_vertex, vertex_index))
+            {
+              match = welded_vertex;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    if (match != NO_VERTEX)
+    {
+      remap[vertex_index] = match;
+      continue;
+    }
+
+    move_vertex(output_mesh, vertex_index, welded_vertex_count);
+
+    struct Cell* cell = find_cell(cells, cell_count, coordinates);
+    memcpy(cell->coordinates, coordinates, sizeof(coordinates));
+    next_vertices[welded_vertex_count] = cell->first_vertex;
+    cell->first_vertex = welded_vertex_count;
+
+    remap[vertex_index] = welded_vertex_count++;
+  }
+
+  for (uint64_t index = 0; index < output_mesh->index_count; ++index)
+  {
+    output_mesh->indices[index] = remap[output_mesh->indices[index]];
+  }
+
+  output_mesh->vertex_count = welded_vertex_count;
+
+  free(cells);
+  free(next_vertices);
+  free(remap);
+}
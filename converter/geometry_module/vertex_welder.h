@@ -0,0 +1,7 @@
+#pragma once
+
+typedef struct OutputMesh OutputMesh;
+
+// Merges vertices whose attributes are within the weld epsilons of each other, remaps the indices and compacts the
+// vertices of the mesh. Joint indices always have to match exactly.
+void weld_vertices(OutputMesh* output_mesh);
@@ -8,10 +8,33 @@
 
 #include <cgltf/cgltf.h>
 
+#define SECTION_ALIGNMENT 16        // Every section starts at a multiple of this many bytes
+#define SECTION_PAGE_ALIGNMENT 4096 // Large buffers start on a page so that they can be mapped and read directly
+
+#define SECTION_FLAG_LOAD_TIME (1 << 0)
+#define SECTION_FLAG_PAGE_ALIGNED (1 << 1)
+
+struct SectionEntry
+{
+  uint32_t flags;
+  uint64_t offset, size;
+};
+
+static struct SectionEntry section_entries[AEMModelSection_Count];
+static long section_table_offset;
+
+static bool is_page_aligned(enum AEMModelSection section)
+{
+  return section == AEMModelSection_VertexBuffer || section == AEMModelSection_PositionBuffer ||
+         section == AEMModelSection_IndexBuffer || section == AEMModelSection_ImageBuffer;
+}
+
 void write_header(const struct cgltf_data* input_file, FILE* output_file)
 {
   const uint32_t vertex_count = geo_calculate_vertex_count();
+  const uint32_t vertex_format = geo_calculate_vertex_format();
   const uint32_t index_count = geo_calculate_index_count();
+  const uint64_t index_buffer_size = geo_get_index_buffer_size();
   const uint64_t image_buffer_size = mat_calculate_image_buffer_size();
   const uint32_t texture_count = mat_get_texture_count();
   const uint32_t mesh_count = geo_get_mesh_count();
@@ -20,10 +43,11 @@ void write_header(const struct cgltf_data* input_file, FILE* output_file)
   const uint32_t animation_count = (uint32_t)input_file->animations_count;
   const uint32_t track_count = animation_count * joint_count;
   const uint32_t keyframe_count = anim_get_keyframe_count();
+  const uint64_t joint_names_size = anim_calculate_joint_names_size();
 
   // Write the magic number
   {
-    const char id[4] = "AEM\1";
+    const char id[4] = "AEM\2";
     fwrite(id, sizeof(id), 1, output_file);
   }
 
@@ -39,9 +63,25 @@ void write_header(const struct cgltf_data* input_file, FILE* output_file)
     fwrite(&animation_count, sizeof(animation_count), 1, output_file);
     fwrite(&track_count, sizeof(track_count), 1, output_file);
     fwrite(&keyframe_count, sizeof(keyframe_count), 1, output_file);
+    fwrite(&vertex_format, sizeof(vertex_format), 1, output_file);
+    fwrite(&index_buffer_size, sizeof(index_buffer_size), 1, output_file);
+    fwrite(&joint_names_size, sizeof(joint_names_size), 1, output_file);
+  }
 
-    uint32_t padding = 0;
+  // Reserve the table of contents, it is filled in once the offsets and sizes of all sections are known
+  {
+    const uint32_t section_count = AEMModelSection_Count;
+    const uint32_t padding = 0;
+    fwrite(&section_count, sizeof(section_count), 1, output_file);
     fwrite(&padding, sizeof(padding), 1, output_file);
+
+    section_table_offset = ftell(output_file);
+
+    const uint8_t entry[24] = { 0 };
+    for (uint32_t section = 0; section < section_count; ++section)
+    {
+      fwrite(entry, sizeof(entry), 1, output_file);
+    }
   }
 
 #ifdef PRINT_HEADER
@@ -56,5 +96,53 @@ void write_header(const struct cgltf_data* input_file, FILE* output_file)
   printf("\tAnimation count: %u\n", animation_count);
   printf("\tTrack count: %u\n", track_count);
   printf("\tKeyframe count: %u\n", keyframe_count);
+  printf("\tVertex format: 0x%x\n", vertex_format);
+  printf("\tIndex buffer size: %llu bytes\n", index_buffer_size);
+  printf("\tJoint names size: %llu bytes\n", joint_names_size);
+#endif
+}
+
+void begin_section(enum AEMModelSection section, FILE* output_file)
+{
+  const long alignment = is_page_aligned(section) ? SECTION_PAGE_ALIGNMENT : SECTION_ALIGNMENT;
+  const long offset = ftell(output_file);
+  const long padding_size = (alignment - offset % alignment) % alignment;
+
+  const uint8_t padding[SECTION_PAGE_ALIGNMENT] = { 0 };
+  fwrite(padding, 1, padding_size, output_file);
+
+  struct SectionEntry* entry = &section_entries[section];
+  entry->offset = (uint64_t)(offset + padding_size);
+  entry->flags = is_page_aligned(section) ? SECTION_FLAG_PAGE_ALIGNED : 0;
+  if (section <= AEMModelSection_Textures)
+  {
+    entry->flags |= SECTION_FLAG_LOAD_TIME;
+  }
+}
+
+void end_section(enum AEMModelSection section, FILE* output_file)
+{
+  struct SectionEntry* entry = &section_entries[section];
+  entry->size = (uint64_t)ftell(output_file) - entry->offset;
+}
+
+void write_section_table(FILE* output_file)
+{
+  const long end = ftell(output_file);
+  fseek(output_file, section_table_offset, SEEK_SET);
+
+  for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+  {
+    const struct SectionEntry* entry = &section_entries[section];
+    fwrite(&section, sizeof(section), 1, output_file);
+    fwrite(&entry->flags, sizeof(entry->flags), 1, output_file);
+    fwrite(&entry->offset, sizeof(entry->offset), 1, output_file);
+    fwrite(&entry->size, sizeof(entry->size), 1, output_file);
+
+#ifdef PRINT_HEADER
+    printf("\tSection %u: %llu bytes at offset %llu\n", section, entry->size, entry->offset);
 #endif
+  }
+
+  fseek(output_file, end, SEEK_SET);
 }
\ No newline at end of file
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <aem/model.h>
+
 #include <stdint.h>
 #include <stdio.h>
 
 typedef struct cgltf_data cgltf_data;
 
-void write_header(const cgltf_data* input_file, FILE* output_file);
\ No newline at end of file
+void write_header(const cgltf_data* input_file, FILE* output_file);
+
+// Each section is written between these calls so that the table of contents can locate it
+void begin_section(enum AEMModelSection section, FILE* output_file);
+void end_section(enum AEMModelSection section, FILE* output_file);
+
+// Fills in the table of contents once all sections have been written
+void write_section_table(FILE* output_file);
\ No newline at end of file
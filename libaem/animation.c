@@ -1,151 +1,340 @@
 #include "animation_mixer.h"
 #include "common.h"
+#include "memory.h"
 #include "model.h"
+#include "pose_cache.h"
+#include "simd.h"
 
+#include <cglm/affine-mat.h>
 #include <cglm/mat4.h>
 #include <cglm/quat.h>
 
-static uint32_t get_keyframe_index_after(float time, struct Keyframe* keyframes, uint32_t keyframe_count)
+#include <math.h>
+#include <string.h>
+
+#define KEYFRAME_CURSOR_STEP_COUNT 2 // How far a cursor is moved forward before falling back to a binary search
+#define NLERP_MIN_COS 0.985f // Closer rotations are blended with a normalized lerp, off by less than 0.01 degrees
+
+// Whether the keyframe is the first one at or after the time, which is one past the last keyframe if there is none
+static bool
+is_keyframe_index_after(float time, const struct Keyframe* keyframes, uint32_t keyframe_count, uint32_t index)
+{
+  return (index == keyframe_count || keyframes[index].time >= time) && (index == 0 || keyframes[index - 1].time < time);
+}
+
+// The cursor is optional and remembers the last result, as playback mostly moves forward by less than a keyframe per
+// frame, checking around it first makes the lookup constant time in practice
+static uint32_t
+get_keyframe_index_after(float time, const struct Keyframe* keyframes, uint32_t keyframe_count, uint32_t* cursor)
 {
-  uint32_t after_index = keyframe_count;
-  for (uint32_t keyframe_index = 0; keyframe_index < keyframe_count; ++keyframe_index)
+  if (cursor)
   {
-    if (keyframes[keyframe_index].time >= time)
+    uint32_t index = *cursor;
+    for (uint32_t step = 0; step < KEYFRAME_CURSOR_STEP_COUNT && index <= keyframe_count; ++step, ++index)
     {
-      after_index = keyframe_index;
-      break;
+      if (is_keyframe_index_after(time, keyframes, keyframe_count, index))
+      {
+        *cursor = index;
+        return index;
+      }
     }
   }
 
-  return after_index;
-}
-
-static void get_keyframe_blend_vec3(float time, struct Keyframe* keyframes, uint32_t keyframe_count, vec3 out)
-{
-  uint32_t keyframe_index = get_keyframe_index_after(time, keyframes, keyframe_count);
-
-  // Before the first keyframe
-  if (keyframe_index == 0)
+  // Binary search for the first keyframe at or after the time
+  uint32_t first = 0, last = keyframe_count;
+  while (first < last)
   {
-    glm_vec3_make(keyframes[0].data, out);
+    const uint32_t middle = first + (last - first) / 2;
+    if (keyframes[middle].time >= time)
+    {
+      last = middle;
+    }
+    else
+    {
+      first = middle + 1;
+    }
   }
-  // After the last keyframe
-  else if (keyframe_index == keyframe_count)
+
+  if (cursor)
   {
-    glm_vec3_make(keyframes[keyframe_count - 1].data, out);
+    *cursor = first;
   }
-  // Blend keyframes in the middle
-  else
-  {
-    struct Keyframe* keyframe_from = &keyframes[keyframe_index - 1];
-    struct Keyframe* keyframe_to = &keyframes[keyframe_index];
-
-    vec3 from;
-    glm_vec3_make(keyframe_from->data, from);
-
-    vec3 to;
-    glm_vec3_make(keyframe_to->data, to);
 
-    const float blend = (time - keyframe_from->time) / (keyframe_to->time - keyframe_from->time);
-    glm_vec3_lerp(from, to, blend, out);
-  }
+  return first;
 }
 
-static void get_keyframe_blend_quat(float time, struct Keyframe* keyframes, uint32_t keyframe_count, versor out)
+// Finds the keyframes around the time and returns how far the time is between them, both are the same keyframe if
+// the time is outside of the keyframes
+static float get_keyframe_pair(float time,
+                               const struct Keyframe* keyframes,
+                               uint32_t keyframe_count,
+                               uint32_t* cursor,
+                               const float** from,
+                               const float** to)
 {
-  uint32_t keyframe_index = get_keyframe_index_after(time, keyframes, keyframe_count);
+  const uint32_t keyframe_index = get_keyframe_index_after(time, keyframes, keyframe_count, cursor);
 
   // Before the first keyframe
   if (keyframe_index == 0)
   {
-    glm_quat_make(keyframes[0].data, out);
+    *from = *to = keyframes[0].data;
+    return 0.0f;
   }
+
   // After the last keyframe
-  else if (keyframe_index == keyframe_count)
+  if (keyframe_index == keyframe_count)
   {
-    glm_quat_make(keyframes[keyframe_count - 1].data, out);
+    *from = *to = keyframes[keyframe_count - 1].data;
+    return 0.0f;
   }
+
   // Blend keyframes in the middle
-  else
+  const struct Keyframe* keyframe_from = &keyframes[keyframe_index - 1];
+  const struct Keyframe* keyframe_to = &keyframes[keyframe_index];
+  *from = keyframe_from->data;
+  *to = keyframe_to->data;
+  return (time - keyframe_from->time) / (keyframe_to->time - keyframe_from->time);
+}
+
+// Gathers the keyframes of a group of joints into lanes, along with how far to blend between them. Lanes past the
+// last joint are filled with the identity so that they don't produce any invalid values.
+static void sample_joint_lanes(const struct AEMModel* model,
+                               uint32_t first_joint_index,
+                               uint32_t joint_count,
+                               int32_t animation_index,
+                               float time,
+                               uint32_t* cursors, // One per keyframe type for each joint in the model
+                               struct PoseLanes* from,
+                               struct PoseLanes* to,
+                               float blends[KeyframeType_Count][LANE_COUNT])
+{
+  static const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  static const float one[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+  static const float identity[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+  for (uint32_t lane = 0; lane < LANE_COUNT; ++lane)
   {
-    struct Keyframe* keyframe_from = &keyframes[keyframe_index - 1];
-    struct Keyframe* keyframe_to = &keyframes[keyframe_index];
+    const float *translation_from = zero, *translation_to = zero;
+    const float *rotation_from = identity, *rotation_to = identity;
+    const float *scale_from = one, *scale_to = one;
+    float translation_blend = 0.0f, rotation_blend = 0.0f, scale_blend = 0.0f;
+
+    if (lane < joint_count)
+    {
+      const uint32_t joint_index = first_joint_index + lane;
+      const struct Track* track = &model->tracks[animation_index * model->header.joint_count + joint_index];
+      uint32_t* joint_cursors = &cursors[joint_index * KeyframeType_Count];
+
+      const struct Keyframe* keyframes = &model->keyframes[track->first_keyframe_index];
+      if (track->translation_keyframe_count > 0)
+      {
+        translation_blend = get_keyframe_pair(time, keyframes, track->translation_keyframe_count,
+                                              &joint_cursors[KeyframeType_Translation], &translation_from,
+                                              &translation_to);
+      }
+
+      keyframes += track->translation_keyframe_count;
+      if (track->rotation_keyframe_count > 0)
+      {
+        rotation_blend = get_keyframe_pair(time, keyframes, track->rotation_keyframe_count,
+                                           &joint_cursors[KeyframeType_Rotation], &rotation_from, &rotation_to);
+      }
+
+      keyframes += track->rotation_keyframe_count;
+      if (track->scale_keyframe_count > 0)
+      {
+        scale_blend = get_keyframe_pair(time, keyframes, track->scale_keyframe_count,
+                                        &joint_cursors[KeyframeType_Scale], &scale_from, &scale_to);
+      }
+    }
 
-    versor from;
-    glm_quat_make(keyframe_from->data, from);
+    for (uint32_t component = 0; component < 3; ++component)
+    {
+      from->translation[component][lane] = translation_from[component];
+      to->translation[component][lane] = translation_to[component];
+      from->scale[component][lane] = scale_from[component];
+      to->scale[component][lane] = scale_to[component];
+    }
 
-    versor to;
-    glm_quat_make(keyframe_to->data, to);
+    for (uint32_t component = 0; component < 4; ++component)
+    {
+      from->rotation[component][lane] = rotation_from[component];
+      to->rotation[component][lane] = rotation_to[component];
+    }
 
-    float blend = (time - keyframe_from->time) / (keyframe_to->time - keyframe_from->time);
-    glm_quat_slerp(from, to, blend, out);
+    blends[KeyframeType_Translation][lane] = translation_blend;
+    blends[KeyframeType_Rotation][lane] = rotation_blend;
+    blends[KeyframeType_Scale][lane] = scale_blend;
   }
 }
 
-static void get_joint_posed_transform_local_trs(const struct AEMModel* model,
-                                                uint32_t joint_index,
-                                                int32_t animation_index,
-                                                float time,
-                                                vec3 translation,
-                                                versor rotation,
-                                                vec3 scale)
+static void
+lerp_vec3_lanes(const float from[3][LANE_COUNT], const float to[3][LANE_COUNT], Lanes blend, float out[3][LANE_COUNT])
 {
-  const struct Track* track = &model->tracks[animation_index * model->header.joint_count + joint_index];
-
-  const uint32_t translation_keyframe_count = track->translation_keyframe_count;
-  if (translation_keyframe_count > 0)
+  for (uint32_t component = 0; component < 3; ++component)
   {
-    struct Keyframe* translation_keyframes = &model->keyframes[track->first_keyframe_index];
+    const Lanes a = lanes_load(from[component]);
+    const Lanes b = lanes_load(to[component]);
+    lanes_store(lanes_add(a, lanes_mul(lanes_sub(b, a), blend)), out[component]);
+  }
+}
 
-    get_keyframe_blend_vec3(time, translation_keyframes, translation_keyframe_count, translation);
+// Normalized lerp along the shorter arc, which is close to a slerp for rotations that are near each other like
+// neighboring keyframes. Lanes with rotations that are further apart fall back to a slerp.
+static void interpolate_quat_lanes(const float from[4][LANE_COUNT],
+                                   const float to[4][LANE_COUNT],
+                                   Lanes blend,
+                                   float out[4][LANE_COUNT])
+{
+  Lanes a[4], b[4];
+  for (uint32_t component = 0; component < 4; ++component)
+  {
+    a[component] = lanes_load(from[component]);
+    b[component] = lanes_load(to[component]);
   }
-  else
+
+  Lanes dot = lanes_mul(a[0], b[0]);
+  for (uint32_t component = 1; component < 4; ++component)
   {
-    glm_vec3_zero(translation);
+    dot = lanes_add(dot, lanes_mul(a[component], b[component]));
   }
 
-  const uint32_t rotation_keyframe_count = track->rotation_keyframe_count;
-  if (rotation_keyframe_count > 0)
+  Lanes result[4];
+  Lanes length_squared = lanes_set(0.0f);
+  for (uint32_t component = 0; component < 4; ++component)
   {
-    struct Keyframe* rotation_keyframes =
-      &model->keyframes[track->first_keyframe_index + track->translation_keyframe_count];
+    const Lanes shorter_b = lanes_flip_sign(b[component], dot);
+    result[component] = lanes_add(a[component], lanes_mul(lanes_sub(shorter_b, a[component]), blend));
+    length_squared = lanes_add(length_squared, lanes_mul(result[component], result[component]));
+  }
 
-    get_keyframe_blend_quat(time, rotation_keyframes, rotation_keyframe_count, rotation);
+  const Lanes inverse_length = lanes_inverse_sqrt(length_squared);
+
+  float dots[LANE_COUNT], blends[LANE_COUNT], slerp_from[4][LANE_COUNT], slerp_to[4][LANE_COUNT];
+  lanes_store(dot, dots);
+  lanes_store(blend, blends);
+  for (uint32_t component = 0; component < 4; ++component)
+  {
+    // The output may be the same as one of the inputs, keep the inputs around for the slerp fallback
+    lanes_store(a[component], slerp_from[component]);
+    lanes_store(b[component], slerp_to[component]);
+    lanes_store(lanes_mul(result[component], inverse_length), out[component]);
   }
-  else
+
+  for (uint32_t lane = 0; lane < LANE_COUNT; ++lane)
   {
-    glm_quat_identity(rotation);
+    if (fabsf(dots[lane]) >= NLERP_MIN_COS)
+    {
+      continue;
+    }
+
+    versor q, r, slerped;
+    for (uint32_t component = 0; component < 4; ++component)
+    {
+      q[component] = slerp_from[component][lane];
+      r[component] = slerp_to[component][lane];
+    }
+
+    glm_quat_slerp(q, r, blends[lane], slerped);
+
+    for (uint32_t component = 0; component < 4; ++component)
+    {
+      out[component][lane] = slerped[component];
+    }
   }
+}
 
-  const uint32_t scale_keyframe_count = track->scale_keyframe_count;
-  if (scale_keyframe_count > 0)
+// Composes translation * rotation * scale into the matrices directly, the rotation is expected to be normalized
+static void compose_joint_transforms(const struct PoseLanes* pose, uint32_t joint_count, mat4* transforms)
+{
+  const Lanes x = lanes_load(pose->rotation[0]), y = lanes_load(pose->rotation[1]);
+  const Lanes z = lanes_load(pose->rotation[2]), w = lanes_load(pose->rotation[3]);
+  const Lanes two = lanes_set(2.0f), one = lanes_set(1.0f);
+
+  const Lanes x2 = lanes_mul(x, two), y2 = lanes_mul(y, two), z2 = lanes_mul(z, two);
+  const Lanes xx = lanes_mul(x, x2), yy = lanes_mul(y, y2), zz = lanes_mul(z, z2);
+  const Lanes xy = lanes_mul(x, y2), xz = lanes_mul(x, z2), yz = lanes_mul(y, z2);
+  const Lanes wx = lanes_mul(w, x2), wy = lanes_mul(w, y2), wz = lanes_mul(w, z2);
+
+  const Lanes scale_x = lanes_load(pose->scale[0]), scale_y = lanes_load(pose->scale[1]);
+  const Lanes scale_z = lanes_load(pose->scale[2]);
+
+  // Upper 3x3 in column-major order, each column is scaled by the matching scale component
+  float columns[9][LANE_COUNT];
+  lanes_store(lanes_mul(lanes_sub(one, lanes_add(yy, zz)), scale_x), columns[0]);
+  lanes_store(lanes_mul(lanes_add(xy, wz), scale_x), columns[1]);
+  lanes_store(lanes_mul(lanes_sub(xz, wy), scale_x), columns[2]);
+  lanes_store(lanes_mul(lanes_sub(xy, wz), scale_y), columns[3]);
+  lanes_store(lanes_mul(lanes_sub(one, lanes_add(xx, zz)), scale_y), columns[4]);
+  lanes_store(lanes_mul(lanes_add(yz, wx), scale_y), columns[5]);
+  lanes_store(lanes_mul(lanes_add(xz, wy), scale_z), columns[6]);
+  lanes_store(lanes_mul(lanes_sub(yz, wx), scale_z), columns[7]);
+  lanes_store(lanes_mul(lanes_sub(one, lanes_add(xx, yy)), scale_z), columns[8]);
+
+  for (uint32_t lane = 0; lane < joint_count; ++lane)
   {
-    struct Keyframe* scale_keyframes =
-      &model
-         ->keyframes[track->first_keyframe_index + track->translation_keyframe_count + track->rotation_keyframe_count];
+    float* transform = (float*)transforms[lane];
+    for (uint32_t column = 0; column < 3; ++column)
+    {
+      transform[column * 4 + 0] = columns[column * 3 + 0][lane];
+      transform[column * 4 + 1] = columns[column * 3 + 1][lane];
+      transform[column * 4 + 2] = columns[column * 3 + 2][lane];
+      transform[column * 4 + 3] = 0.0f;
+    }
 
-    get_keyframe_blend_vec3(time, scale_keyframes, scale_keyframe_count, scale);
+    transform[12] = pose->translation[0][lane];
+    transform[13] = pose->translation[1][lane];
+    transform[14] = pose->translation[2][lane];
+    transform[15] = 1.0f;
   }
-  else
+}
+
+// The identity in every lane
+static void reset_pose_lanes(struct PoseLanes* pose)
+{
+  for (uint32_t lane = 0; lane < LANE_COUNT; ++lane)
   {
-    glm_vec3_one(scale);
+    for (uint32_t component = 0; component < 3; ++component)
+    {
+      pose->translation[component][lane] = 0.0f;
+      pose->scale[component][lane] = 1.0f;
+      pose->rotation[component][lane] = 0.0f;
+    }
+
+    pose->rotation[3][lane] = 1.0f;
   }
 }
 
 enum AEMAnimationMixerResult
 aem_load_animation_mixer(uint32_t joint_count, uint32_t channel_count, struct AEMAnimationMixer** mixer)
 {
-  *mixer = malloc(sizeof(struct AEMAnimationMixer));
-  if (!*mixer)
+  // The mixer and all of its arrays live in a single allocation, the matrices come first as they are aligned the most
+  const uint32_t group_count = (joint_count + LANE_COUNT - 1) / LANE_COUNT;
+  const size_t matrices_offset = align_up(sizeof(struct AEMAnimationMixer), sizeof(vec4));
+  const size_t sampled_poses_offset = matrices_offset + sizeof(mat4) * joint_count * 2;
+  const size_t cached_poses_offset = sampled_poses_offset + sizeof(struct PoseLanes) * group_count * 2;
+  const size_t channels_offset = cached_poses_offset + sizeof(struct PoseCacheEntry*) * channel_count;
+  const size_t keyframe_cursors_offset = channels_offset + sizeof(struct AEMAnimationChannel) * channel_count;
+  const size_t keyframe_cursors_size = sizeof(uint32_t) * channel_count * joint_count * KeyframeType_Count;
+
+  const struct AEMAllocator* allocator = get_current_allocator();
+  uint8_t* memory = allocate_memory(allocator, keyframe_cursors_offset + keyframe_cursors_size);
+  if (!memory)
   {
+    *mixer = NULL;
     return AEMAnimationMixerResult_OutOfMemory;
   }
 
-  (*mixer)->channels = malloc(sizeof(*(*mixer)->channels) * channel_count);
-  if (!(*mixer)->channels)
-  {
-    return AEMAnimationMixerResult_OutOfMemory;
-  }
+  *mixer = (struct AEMAnimationMixer*)memory;
+  (*mixer)->allocator = *allocator;
+
+  // Local and global transforms, followed by two samples to interpolate between when the update rate is throttled
+  (*mixer)->joint_transforms = (float*)(memory + matrices_offset);
+  (*mixer)->global_joint_transforms = (*mixer)->joint_transforms + 16 * joint_count;
+  (*mixer)->sampled_poses = (struct PoseLanes*)(memory + sampled_poses_offset);
+  (*mixer)->cached_poses = (struct PoseCacheEntry**)(memory + cached_poses_offset);
+  (*mixer)->channels = (struct AEMAnimationChannel*)(memory + channels_offset);
+  (*mixer)->keyframe_cursors = (uint32_t*)(memory + keyframe_cursors_offset);
 
   for (uint32_t channel_index = 0; channel_index < channel_count; ++channel_index)
   {
@@ -160,12 +349,20 @@ aem_load_animation_mixer(uint32_t joint_count, uint32_t channel_count, struct AE
     channel->weight = (channel_index == 0) ? 1.0f : 0.0f;
   }
 
-  (*mixer)->joint_transforms = malloc(sizeof(mat4) * joint_count);
-  if (!(*mixer)->joint_transforms)
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
   {
-    return AEMAnimationMixerResult_OutOfMemory;
+    glm_mat4_identity(((mat4*)(*mixer)->joint_transforms)[joint_index]);
+    glm_mat4_identity(((mat4*)(*mixer)->global_joint_transforms)[joint_index]);
   }
 
+  // Groups outside of a joint mask are never sampled but may still be interpolated once the mask changes
+  for (uint32_t group_index = 0; group_index < group_count * 2; ++group_index)
+  {
+    reset_pose_lanes(&(*mixer)->sampled_poses[group_index]);
+  }
+
+  memset((*mixer)->keyframe_cursors, 0, keyframe_cursors_size);
+
   (*mixer)->channel_count = channel_count;
   (*mixer)->joint_count = joint_count;
 
@@ -178,6 +375,15 @@ aem_load_animation_mixer(uint32_t joint_count, uint32_t channel_count, struct AE
   (*mixer)->blend_speed = 1.0f;
   (*mixer)->blend_mode = AEMAnimationBlendMode_Smooth;
 
+  (*mixer)->joint_transform_format = AEMJointTransformFormat_Matrix4x4;
+
+  (*mixer)->update_interval = 0.0f;
+  (*mixer)->time_since_sample = 0.0f;
+  (*mixer)->sample_index = 0;
+  (*mixer)->has_sample = false;
+  (*mixer)->lod_mask = NULL;
+  (*mixer)->pose_cache = NULL;
+
   return AEMAnimationMixerResult_Success;
 }
 
@@ -211,11 +417,65 @@ void aem_set_animation_mixer_blend_mode(struct AEMAnimationMixer* mixer, enum AE
   mixer->blend_mode = blend_mode;
 }
 
+enum AEMJointTransformFormat aem_get_animation_mixer_joint_transform_format(const struct AEMAnimationMixer* mixer)
+{
+  return mixer->joint_transform_format;
+}
+
+void aem_set_animation_mixer_joint_transform_format(struct AEMAnimationMixer* mixer,
+                                                    enum AEMJointTransformFormat joint_transform_format)
+{
+  mixer->joint_transform_format = joint_transform_format;
+}
+
+float aem_get_animation_mixer_update_interval(const struct AEMAnimationMixer* mixer)
+{
+  return mixer->update_interval;
+}
+
+void aem_set_animation_mixer_update_interval(struct AEMAnimationMixer* mixer, float update_interval)
+{
+  mixer->update_interval = update_interval;
+  mixer->has_sample = false; // The samples to interpolate between might be out of date
+}
+
+const struct AEMJointMask* aem_get_animation_mixer_lod_mask(const struct AEMAnimationMixer* mixer)
+{
+  return mixer->lod_mask;
+}
+
+void aem_set_animation_mixer_lod_mask(struct AEMAnimationMixer* mixer, const struct AEMJointMask* lod_mask)
+{
+  mixer->lod_mask = lod_mask;
+}
+
+struct AEMPoseCache* aem_get_animation_mixer_pose_cache(const struct AEMAnimationMixer* mixer)
+{
+  return mixer->pose_cache;
+}
+
+void aem_set_animation_mixer_pose_cache(struct AEMAnimationMixer* mixer, struct AEMPoseCache* pose_cache)
+{
+  mixer->pose_cache = pose_cache;
+}
+
+uint32_t aem_get_joint_transform_size(enum AEMJointTransformFormat joint_transform_format)
+{
+  if (joint_transform_format == AEMJointTransformFormat_Matrix3x4)
+  {
+    return 12;
+  }
+  else if (joint_transform_format == AEMJointTransformFormat_DualQuaternion)
+  {
+    return 8;
+  }
+
+  return 16;
+}
+
 void aem_free_animation_mixer(struct AEMAnimationMixer* mixer)
 {
-  free(mixer->channels);
-  free(mixer->joint_transforms);
-  free(mixer);
+  free_memory(&mixer->allocator, mixer);
 }
 
 struct AEMAnimationChannel*
@@ -229,15 +489,11 @@ void aem_get_animation_mixer_joint_transform(const struct AEMModel* model,
                                              uint32_t joint_index,
                                              float transform[16])
 {
-  mat4* t = (mat4*)mixer->joint_transforms;
-  glm_mat4_copy(t[joint_index], (vec4*)transform);
+  (void)model; // The global transforms are cached by the last update
 
-  int32_t parent_joint_index = model->joints[joint_index].parent_joint_index;
-  while (parent_joint_index >= 0)
-  {
-    glm_mat4_mul(t[parent_joint_index], (vec4*)transform, (vec4*)transform);
-    parent_joint_index = model->joints[parent_joint_index].parent_joint_index;
-  }
+  // The output is a plain float array, which might not be aligned for the SIMD copy of cglm
+  const mat4* global_transforms = (const mat4*)mixer->global_joint_transforms;
+  memcpy(transform, global_transforms[joint_index], sizeof(mat4));
 }
 
 void aem_cut_to_animation_mixer_channel(struct AEMAnimationMixer* mixer, uint32_t channel_index_)
@@ -259,6 +515,17 @@ void aem_blend_to_animation_mixer_channel(struct AEMAnimationMixer* mixer, uint3
   mixer->blend_progress = 0.0f;
 }
 
+// Channels without weight or without a valid animation don't contribute and are not sampled at all
+static float get_channel_blend_weight(const struct AEMModel* model, const struct AEMAnimationChannel* channel)
+{
+  if (channel->weight <= 0.0f || channel->animation_index >= model->header.animation_count)
+  {
+    return 0.0f;
+  }
+
+  return channel->weight;
+}
+
 static float smoothstep(float x)
 {
   return x * x * (3.0f - 2.0f * x);
@@ -269,19 +536,325 @@ static float smootherstep(float x)
   return x * x * x * (x * (x * 6.0f - 15.0f) + 10.0f);
 }
 
-void aem_update_animation(const struct AEMModel* model,
-                          struct AEMAnimationMixer* mixer,
-                          float delta_time,
-                          float* joint_transforms)
+// Writes a skinning transform, which is expected to be rigid apart from scale, in the given format
+static void write_joint_transform(mat4 transform, enum AEMJointTransformFormat joint_transform_format, float* out)
 {
-  mat4* transforms = (mat4*)joint_transforms;
+  if (joint_transform_format == AEMJointTransformFormat_Matrix3x4)
+  {
+    for (uint32_t row = 0; row < 3; ++row)
+    {
+      for (uint32_t column = 0; column < 4; ++column)
+      {
+        out[row * 4 + column] = transform[column][row];
+      }
+    }
+  }
+  else if (joint_transform_format == AEMJointTransformFormat_DualQuaternion)
+  {
+    // Take the scale out of the rotation before converting it to a quaternion
+    mat4 rotation = GLM_MAT4_IDENTITY_INIT;
+    for (uint32_t column = 0; column < 3; ++column)
+    {
+      glm_vec3_normalize_to(transform[column], rotation[column]);
+    }
+
+    versor real;
+    glm_mat4_quat(rotation, real);
+
+    // The dual part is half of the translation times the rotation
+    const float* t = transform[3];
+    out[0] = real[0];
+    out[1] = real[1];
+    out[2] = real[2];
+    out[3] = real[3];
+    out[4] = 0.5f * (t[0] * real[3] + t[1] * real[2] - t[2] * real[1]);
+    out[5] = 0.5f * (-t[0] * real[2] + t[1] * real[3] + t[2] * real[0]);
+    out[6] = 0.5f * (t[0] * real[1] - t[1] * real[0] + t[2] * real[3]);
+    out[7] = -0.5f * (t[0] * real[0] + t[1] * real[1] + t[2] * real[2]);
+  }
+  else
+  {
+    memcpy(out, transform, sizeof(mat4));
+  }
+}
+
+// Joints past the last one of the model are never set, so groups at the end don't need to be handled specially
+static bool is_joint_in_mask(const struct AEMJointMask* mask, uint32_t joint_index)
+{
+  return (mask->bits[joint_index / 32] >> (joint_index % 32)) & 1u;
+}
+
+static bool is_joint_group_in_mask(const struct AEMJointMask* mask, uint32_t first_joint_index)
+{
+  // Groups start at a multiple of the lane count, which divides 32, so a group never spans two words
+  const uint32_t group_bits = (uint32_t)((1ull << LANE_COUNT) - 1);
+  return (mask->bits[first_joint_index / 32] >> (first_joint_index % 32)) & group_bits;
+}
+
+// Joints in the mask in parent-first order, or all joints without a mask
+static uint32_t
+get_ordered_joint_index(const struct AEMModel* model, const struct AEMJointMask* mask, uint32_t order_index)
+{
+  if (mask)
+  {
+    return mask->joint_indices[order_index];
+  }
+
+  return model->joint_order ? model->joint_order[order_index] : order_index;
+}
+
+// Samples the local transforms of a group of joints in one animation
+static void sample_animation_lanes(const struct AEMModel* model,
+                                   uint32_t first_joint_index,
+                                   uint32_t joint_count,
+                                   int32_t animation_index,
+                                   float time,
+                                   uint32_t* cursors,
+                                   struct PoseLanes* sampled)
+{
+  struct PoseLanes from, to;
+  float blends[KeyframeType_Count][LANE_COUNT];
+  sample_joint_lanes(model, first_joint_index, joint_count, animation_index, time, cursors, &from, &to, blends);
+
+  lerp_vec3_lanes(from.translation, to.translation, lanes_load(blends[KeyframeType_Translation]), sampled->translation);
+  interpolate_quat_lanes(from.rotation, to.rotation, lanes_load(blends[KeyframeType_Rotation]), sampled->rotation);
+  lerp_vec3_lanes(from.scale, to.scale, lanes_load(blends[KeyframeType_Scale]), sampled->scale);
+}
+
+// Looks up the poses of the channels in the pose cache of the mixer and samples the ones that are missing, channels
+// without a cached pose are sampled as usual
+static void acquire_cached_poses(const struct AEMModel* model, struct AEMAnimationMixer* mixer)
+{
+  struct AEMPoseCache* pose_cache = mixer->pose_cache;
+  for (uint32_t channel_index = 0; channel_index < mixer->channel_count; ++channel_index)
+  {
+    mixer->cached_poses[channel_index] = NULL;
+
+    const struct AEMAnimationChannel* channel = &mixer->channels[channel_index];
+    if (!pose_cache || mixer->joint_count > pose_cache->joint_count || get_channel_blend_weight(model, channel) <= 0.0f)
+    {
+      continue;
+    }
+
+    // Instances share a pose if their times round to the same step
+    const int32_t time_index = (int32_t)floorf(channel->time / pose_cache->time_step + 0.5f);
+
+    bool needs_sampling;
+    struct PoseCacheEntry* entry =
+      acquire_pose_cache_entry(pose_cache, model, channel->animation_index, time_index, &needs_sampling);
+    if (entry && needs_sampling)
+    {
+      // Sample the whole skeleton so that the pose can be shared no matter which joints this mixer needs
+      const float time = (float)time_index * pose_cache->time_step;
+      uint32_t* cursors = &mixer->keyframe_cursors[channel_index * mixer->joint_count * KeyframeType_Count];
+      for (uint32_t first_joint_index = 0; first_joint_index < mixer->joint_count; first_joint_index += LANE_COUNT)
+      {
+        const uint32_t remaining_joint_count = mixer->joint_count - first_joint_index;
+        const uint32_t joint_count = remaining_joint_count < LANE_COUNT ? remaining_joint_count : LANE_COUNT;
+        sample_animation_lanes(model, first_joint_index, joint_count, channel->animation_index, time, cursors,
+                               &entry->groups[first_joint_index / LANE_COUNT]);
+      }
+    }
+
+    mixer->cached_poses[channel_index] = entry;
+  }
+}
+
+static void release_cached_poses(struct AEMAnimationMixer* mixer)
+{
+  for (uint32_t channel_index = 0; channel_index < mixer->channel_count; ++channel_index)
+  {
+    if (mixer->cached_poses[channel_index])
+    {
+      release_pose_cache_entry(mixer->pose_cache, mixer->cached_poses[channel_index]);
+    }
+  }
+}
+
+// Joints outside of the LOD mask keep their last local transforms. The blended poses are stored in the optional poses,
+// one per group of joints, instead of being composed into the local transforms.
+static void sample_local_joint_transforms(const struct AEMModel* model,
+                                          struct AEMAnimationMixer* mixer,
+                                          const struct AEMJointMask* mask,
+                                          const struct AEMJointMask* lod_mask,
+                                          struct PoseLanes* poses)
+{
+  mat4* cached_transforms = (mat4*)mixer->joint_transforms;
+
+  acquire_cached_poses(model, mixer);
+
+  // Sample and blend groups of joints at once, one joint per lane
+  for (uint32_t first_joint_index = 0; first_joint_index < mixer->joint_count; first_joint_index += LANE_COUNT)
+  {
+    const uint32_t remaining_joint_count = mixer->joint_count - first_joint_index;
+    const uint32_t joint_count = remaining_joint_count < LANE_COUNT ? remaining_joint_count : LANE_COUNT;
+
+    // Joints outside of the masks are still evaluated if another joint in their group is needed
+    if ((mask && !is_joint_group_in_mask(mask, first_joint_index)) ||
+        (lod_mask && !is_joint_group_in_mask(lod_mask, first_joint_index)))
+    {
+      continue;
+    }
+
+    // The local transforms are left as identity if no channel contributes
+    struct PoseLanes blended;
+    reset_pose_lanes(&blended);
+
+    float total_weight = 0.0f;
+    for (uint32_t channel_index = 0; channel_index < mixer->channel_count; ++channel_index)
+    {
+      const struct AEMAnimationChannel* channel = &mixer->channels[channel_index];
+      const float weight = get_channel_blend_weight(model, channel);
+      if (weight <= 0.0f)
+      {
+        continue;
+      }
+
+      struct PoseLanes sampled;
+      if (mixer->cached_poses[channel_index])
+      {
+        sampled = mixer->cached_poses[channel_index]->groups[first_joint_index / LANE_COUNT];
+      }
+      else
+      {
+        uint32_t* cursors = &mixer->keyframe_cursors[channel_index * mixer->joint_count * KeyframeType_Count];
+        sample_animation_lanes(model, first_joint_index, joint_count, channel->animation_index, channel->time, cursors,
+                               &sampled);
+      }
+
+      // Blending each channel in by its share of the weight so far weighs all channels by their weight in the end
+      total_weight += weight;
+      if (total_weight == weight)
+      {
+        blended = sampled;
+      }
+      else
+      {
+        const Lanes blend = lanes_set(weight / total_weight);
+        lerp_vec3_lanes(blended.translation, sampled.translation, blend, blended.translation);
+        interpolate_quat_lanes(blended.rotation, sampled.rotation, blend, blended.rotation);
+        lerp_vec3_lanes(blended.scale, sampled.scale, blend, blended.scale);
+      }
+    }
+
+    if (poses)
+    {
+      poses[first_joint_index / LANE_COUNT] = blended;
+    }
+    else
+    {
+      compose_joint_transforms(&blended, joint_count, &cached_transforms[first_joint_index]);
+    }
+  }
+
+  release_cached_poses(mixer);
+}
+
+// Interpolates the local transforms between the last two samples of a throttled mixer, so that rotations stay rigid
+static void interpolate_sampled_poses(struct AEMAnimationMixer* mixer, const struct AEMJointMask* mask, float blend)
+{
+  const uint32_t group_count = (mixer->joint_count + LANE_COUNT - 1) / LANE_COUNT;
+  const struct PoseLanes* previous_sample = &mixer->sampled_poses[(mixer->sample_index ^ 1) * group_count];
+  const struct PoseLanes* current_sample = &mixer->sampled_poses[mixer->sample_index * group_count];
+  mat4* cached_transforms = (mat4*)mixer->joint_transforms;
+
+  const Lanes blend_lanes = lanes_set(blend);
+  for (uint32_t first_joint_index = 0; first_joint_index < mixer->joint_count; first_joint_index += LANE_COUNT)
+  {
+    if (mask && !is_joint_group_in_mask(mask, first_joint_index))
+    {
+      continue;
+    }
+
+    const uint32_t remaining_joint_count = mixer->joint_count - first_joint_index;
+    const uint32_t joint_count = remaining_joint_count < LANE_COUNT ? remaining_joint_count : LANE_COUNT;
+
+    const struct PoseLanes* previous = &previous_sample[first_joint_index / LANE_COUNT];
+    const struct PoseLanes* current = &current_sample[first_joint_index / LANE_COUNT];
+
+    struct PoseLanes interpolated;
+    lerp_vec3_lanes(previous->translation, current->translation, blend_lanes, interpolated.translation);
+    interpolate_quat_lanes(previous->rotation, current->rotation, blend_lanes, interpolated.rotation);
+    lerp_vec3_lanes(previous->scale, current->scale, blend_lanes, interpolated.scale);
+
+    compose_joint_transforms(&interpolated, joint_count, &cached_transforms[first_joint_index]);
+  }
+}
+
+static void compute_global_joint_transforms(const struct AEMModel* model,
+                                            const struct AEMAnimationMixer* mixer,
+                                            const struct AEMJointMask* mask,
+                                            mat4* global_transforms)
+{
+  const mat4* cached_transforms = (const mat4*)mixer->joint_transforms;
+
+  // Parents come before their children, so the global transform of the parent is always ready
+  const uint32_t order_count = mask ? mask->joint_count : mixer->joint_count;
+  for (uint32_t order_index = 0; order_index < order_count; ++order_index)
+  {
+    const uint32_t joint_index = get_ordered_joint_index(model, mask, order_index);
+
+    const int32_t parent_joint_index = model->joint_parent_indices[joint_index];
+    if (parent_joint_index >= 0)
+    {
+      glm_mul(global_transforms[parent_joint_index], (vec4*)cached_transforms[joint_index],
+              global_transforms[joint_index]);
+    }
+    else
+    {
+      glm_mat4_copy((vec4*)cached_transforms[joint_index], global_transforms[joint_index]);
+    }
+  }
+}
+
+// Only an estimate, as joints that share a group with a sampled joint are sampled as well
+static uint32_t get_sampled_joint_count(const struct AEMAnimationMixer* mixer,
+                                        const struct AEMJointMask* mask,
+                                        const struct AEMJointMask* lod_mask)
+{
+  uint32_t joint_count = mixer->joint_count;
+  if (mask && mask->joint_count < joint_count)
+  {
+    joint_count = mask->joint_count;
+  }
+
+  if (lod_mask && lod_mask->joint_count < joint_count)
+  {
+    joint_count = lod_mask->joint_count;
+  }
+
+  return joint_count;
+}
+
+// Evaluates all joints without a mask, the joint transforms are optional with a mask. Without a budget the mixer
+// samples whenever it is due.
+static void update_animation(const struct AEMModel* model,
+                             struct AEMAnimationMixer* mixer,
+                             float delta_time,
+                             const struct AEMJointMask* mask,
+                             uint32_t* joint_budget,
+                             float* joint_transforms)
+{
+  const enum AEMJointTransformFormat joint_transform_format = mixer->joint_transform_format;
+  const uint32_t joint_transform_size = aem_get_joint_transform_size(joint_transform_format);
 
   // Show the bind pose and early out if the mixer is not enabled
   if (!mixer->is_enabled)
   {
+    if (!joint_transforms)
+    {
+      return;
+    }
+
+    mat4 identity = GLM_MAT4_IDENTITY_INIT;
     for (uint32_t joint_index = 0; joint_index < mixer->joint_count; ++joint_index)
     {
-      glm_mat4_identity(transforms[joint_index]);
+      if (mask && !is_joint_in_mask(mask, joint_index))
+      {
+        continue;
+      }
+
+      write_joint_transform(identity, joint_transform_format, &joint_transforms[joint_index * joint_transform_size]);
     }
 
     return;
@@ -376,86 +949,201 @@ void aem_update_animation(const struct AEMModel* model,
     }
   }
 
-  mat4* cached_transforms = (mat4*)mixer->joint_transforms;
+  // Throttled mixers only sample when their interval is up and interpolate between the last two samples otherwise
+  const bool is_throttled = mixer->update_interval > 0.0f;
+  mixer->time_since_sample += delta_time;
+  bool should_sample = !mixer->has_sample || !is_throttled || mixer->time_since_sample >= mixer->update_interval;
+
+  // Frozen joints need a pose to stay in, so the first sample ignores the LOD mask
+  const struct AEMJointMask* lod_mask = mixer->has_sample ? mixer->lod_mask : NULL;
 
-  for (uint32_t joint_index = 0; joint_index < mixer->joint_count; ++joint_index)
+  // Sampling is skipped altogether if it doesn't fit into the budget, the last pose is shown instead. Without a last
+  // pose the mixer samples anyway and uses up what is left of the budget, counting every joint as the LOD mask is off.
+  if (should_sample && joint_budget)
   {
-    vec3 t[4], s[4];
-    versor r[4];
-    for (uint32_t channel_index = 0; channel_index < 4; ++channel_index)
+    const uint32_t sampled_joint_count = get_sampled_joint_count(mixer, mask, lod_mask);
+    if (!mixer->has_sample)
     {
-      struct AEMAnimationChannel* channel = &mixer->channels[channel_index];
-      get_joint_posed_transform_local_trs(model, joint_index, mixer->channels[channel_index].animation_index,
-                                          mixer->channels[channel_index].time, t[channel_index], r[channel_index],
-                                          s[channel_index]);
+      *joint_budget -= sampled_joint_count < *joint_budget ? sampled_joint_count : *joint_budget;
     }
-
-    // Blend a and b
-    vec3 t_ab, s_ab;
-    versor r_ab;
-    const float weight_a = mixer->channels[0].weight;
-    const float weight_b = mixer->channels[1].weight;
+    else if (sampled_joint_count > *joint_budget)
     {
-      float blend = 0.0f;
-      if (weight_a + weight_b > 0.0f)
-      {
-        blend = weight_b / (weight_a + weight_b);
-      }
-
-      glm_vec3_lerp(t[0], t[1], blend, t_ab);
-      glm_quat_slerp(r[0], r[1], blend, r_ab);
-      glm_vec3_lerp(s[0], s[1], blend, s_ab);
+      should_sample = false;
     }
+    else
+    {
+      *joint_budget -= sampled_joint_count;
+    }
+  }
 
-    // Blend c and d
-    vec3 t_cd, s_cd;
-    versor r_cd;
-    const float weight_c = mixer->channels[2].weight;
-    const float weight_d = mixer->channels[3].weight;
+  mat4* global_transforms = (mat4*)mixer->global_joint_transforms;
+  const uint32_t order_count = mask ? mask->joint_count : mixer->joint_count;
+  if (should_sample)
+  {
+    if (is_throttled)
     {
-      float blend = 0.0f;
-      if (weight_c + weight_d > 0.0f)
+      // Groups that are not sampled, like frozen ones, keep their pose in the new sample
+      const uint32_t group_count = (mixer->joint_count + LANE_COUNT - 1) / LANE_COUNT;
+      struct PoseLanes* previous_sample = &mixer->sampled_poses[mixer->sample_index * group_count];
+      mixer->sample_index ^= 1;
+      struct PoseLanes* current_sample = &mixer->sampled_poses[mixer->sample_index * group_count];
+      memcpy(current_sample, previous_sample, sizeof(struct PoseLanes) * group_count);
+
+      sample_local_joint_transforms(model, mixer, mask, lod_mask, current_sample);
+
+      // There is nothing to interpolate from yet after the first sample
+      if (!mixer->has_sample)
       {
-        blend = weight_d / (weight_c + weight_d);
+        memcpy(previous_sample, current_sample, sizeof(struct PoseLanes) * group_count);
       }
-
-      glm_vec3_lerp(t[2], t[3], blend, t_cd);
-      glm_quat_slerp(r[2], r[3], blend, r_cd);
-      glm_vec3_lerp(s[2], s[3], blend, s_cd);
     }
-
-    // Blend ab and cd
-    vec3 blended_t, blended_s;
-    versor blended_r;
+    else
     {
-      const float weight_ab = weight_a + weight_b;
-      const float weight_cd = weight_c + weight_d;
-      const float blend = weight_cd / (weight_ab + weight_cd);
-      glm_vec3_lerp(t_ab, t_cd, blend, blended_t);
-      glm_quat_slerp(r_ab, r_cd, blend, blended_r);
-      glm_vec3_lerp(s_ab, s_cd, blend, blended_s);
+      sample_local_joint_transforms(model, mixer, mask, lod_mask, NULL);
+      compute_global_joint_transforms(model, mixer, mask, global_transforms);
     }
 
-    glm_mat4_identity(cached_transforms[joint_index]);
-    glm_translate(cached_transforms[joint_index], blended_t);
-    glm_quat_rotate(cached_transforms[joint_index], blended_r, cached_transforms[joint_index]);
-    glm_scale(cached_transforms[joint_index], blended_s);
+    mixer->has_sample = true;
+    mixer->time_since_sample = 0.0f;
   }
 
-  for (uint32_t joint_index = 0; joint_index < mixer->joint_count; ++joint_index)
+  if (is_throttled)
   {
-    glm_mat4_copy(cached_transforms[joint_index], transforms[joint_index]);
+    interpolate_sampled_poses(mixer, mask, fminf(mixer->time_since_sample / mixer->update_interval, 1.0f));
+    compute_global_joint_transforms(model, mixer, mask, global_transforms);
+  }
 
-    struct AEMJoint* joint = &model->joints[joint_index];
-    int32_t parent_joint_index = joint->parent_joint_index;
-    while (parent_joint_index >= 0)
+  if (!joint_transforms)
+  {
+    return;
+  }
+
+  for (uint32_t order_index = 0; order_index < order_count; ++order_index)
+  {
+    const uint32_t joint_index = get_ordered_joint_index(model, mask, order_index);
+
+    mat4 inverse_bind_matrix, transform;
+    aem_get_model_joint_inverse_bind_matrix(model, joint_index, (float*)inverse_bind_matrix);
+    glm_mul(global_transforms[joint_index], inverse_bind_matrix, transform);
+    write_joint_transform(transform, joint_transform_format, &joint_transforms[joint_index * joint_transform_size]);
+  }
+}
+
+void aem_update_animation(const struct AEMModel* model,
+                          struct AEMAnimationMixer* mixer,
+                          float delta_time,
+                          float* joint_transforms)
+{
+  update_animation(model, mixer, delta_time, NULL, NULL, joint_transforms);
+}
+
+void aem_update_animation_with_budget(const struct AEMModel* model,
+                                      struct AEMAnimationMixer* mixer,
+                                      float delta_time,
+                                      uint32_t* joint_budget,
+                                      float* joint_transforms)
+{
+  update_animation(model, mixer, delta_time, NULL, joint_budget, joint_transforms);
+}
+
+void aem_update_animation_joints(const struct AEMModel* model,
+                                 struct AEMAnimationMixer* mixer,
+                                 float delta_time,
+                                 const struct AEMJointMask* mask,
+                                 float* joint_transforms)
+{
+  update_animation(model, mixer, delta_time, mask, NULL, joint_transforms);
+}
+
+enum AEMAnimationMixerResult aem_create_joint_mask(const struct AEMModel* model,
+                                                   const uint32_t* joint_indices,
+                                                   uint32_t joint_index_count,
+                                                   struct AEMJointMask** mask)
+{
+  const uint32_t joint_count = model->header.joint_count;
+  const uint32_t word_count = (joint_count + 31) / 32;
+
+  // One allocation with room for every joint so that the mask doesn't need to be counted first
+  const struct AEMAllocator* allocator = get_current_allocator();
+  uint8_t* memory =
+    allocate_memory(allocator, sizeof(struct AEMJointMask) + sizeof(uint32_t) * ((size_t)word_count + joint_count));
+  if (!memory)
+  {
+    *mask = NULL;
+    return AEMAnimationMixerResult_OutOfMemory;
+  }
+
+  *mask = (struct AEMJointMask*)memory;
+  (*mask)->allocator = *allocator;
+  (*mask)->bits = (uint32_t*)(memory + sizeof(struct AEMJointMask));
+  (*mask)->joint_indices = (*mask)->bits + word_count;
+  memset((*mask)->bits, 0, sizeof(uint32_t) * word_count);
+
+  // Mark the requested joints and walk up to the root, stopping at the first ancestor that is already marked
+  for (uint32_t index = 0; index < joint_index_count; ++index)
+  {
+    int32_t joint_index = (int32_t)joint_indices[index];
+    while (joint_index >= 0 && !is_joint_in_mask(*mask, (uint32_t)joint_index))
+    {
+      (*mask)->bits[joint_index / 32] |= 1u << (joint_index % 32);
+      joint_index = model->joint_parent_indices[joint_index];
+    }
+  }
+
+  // Keep the parent-first order of the model
+  (*mask)->joint_count = 0;
+  for (uint32_t order_index = 0; order_index < joint_count; ++order_index)
+  {
+    const uint32_t joint_index = model->joint_order ? model->joint_order[order_index] : order_index;
+    if (is_joint_in_mask(*mask, joint_index))
     {
-      glm_mat4_mul(cached_transforms[parent_joint_index], transforms[joint_index], transforms[joint_index]);
-      parent_joint_index = model->joints[parent_joint_index].parent_joint_index;
+      (*mask)->joint_indices[(*mask)->joint_count++] = joint_index;
     }
+  }
+
+  return AEMAnimationMixerResult_Success;
+}
+
+void aem_free_joint_mask(struct AEMJointMask* mask)
+{
+  free_memory(&mask->allocator, mask);
+}
 
-    mat4 inverse_bind_matrix;
-    glm_mat4_make(joint->inverse_bind_matrix, inverse_bind_matrix);
-    glm_mat4_mul(transforms[joint_index], inverse_bind_matrix, transforms[joint_index]);
+uint32_t aem_get_joint_mask_joint_count(const struct AEMJointMask* mask)
+{
+  return mask->joint_count;
+}
+
+struct AnimationBatch
+{
+  const struct AEMModel* model;
+  const struct AEMAnimationUpdate* updates;
+};
+
+static void update_animation_job(void* job_data, uint32_t job_index)
+{
+  const struct AnimationBatch* batch = (const struct AnimationBatch*)job_data;
+  const struct AEMAnimationUpdate* update = &batch->updates[job_index];
+  aem_update_animation(batch->model, update->mixer, update->delta_time, update->joint_transforms);
+}
+
+void aem_update_animations_batch(const struct AEMModel* model,
+                                 const struct AEMAnimationUpdate* updates,
+                                 uint32_t update_count,
+                                 AEMAnimationJobDispatcher dispatcher,
+                                 void* dispatcher_user_data)
+{
+  struct AnimationBatch batch = { model, updates };
+
+  if (!dispatcher)
+  {
+    for (uint32_t update_index = 0; update_index < update_count; ++update_index)
+    {
+      update_animation_job(&batch, update_index);
+    }
+    return;
   }
-}
\ No newline at end of file
+
+  // Instances only share the model, which is read-only during updates, so they can run in any order and in parallel
+  dispatcher(dispatcher_user_data, update_animation_job, &batch, update_count);
+}
@@ -1,26 +1,65 @@
 #pragma once
 
+#include "allocator.h"
 #include "animation_mixer.h"
 #include "model.h"
+#include "platform.h"
 
 #include <stdbool.h>
 #include <stdio.h>
 
+struct PoseCacheEntry;
+
 struct Header
 {
   uint32_t vertex_count, index_count;
   uint64_t image_buffer_size;
   uint32_t texture_count, mesh_count, material_count;
   uint32_t joint_count, animation_count, track_count, keyframe_count;
+  uint32_t vertex_format; // Padding in version 1, which only has full precision vertices
+
+  uint64_t index_buffer_size; // Not stored in version 1, which only has 32-bit indices
+  uint64_t joint_names_size;  // Not stored in version 1, which stores the names with the joints
+
+  // Sizes of optional sections, which are not stored in the header but taken from the table of contents
+  uint64_t mesh_lods_size, meshlets_size, bounds_size;
+};
+
+// Meshes in version 1 files don't have an index type and base vertex, they are upgraded while loading
+struct MeshV1
+{
+  uint32_t first_index, index_count;
+  uint32_t material_index;
+};
+
+// Joints in version 1 files interleave the cold name with the hot data, they are split up while loading
+struct JointV1
+{
+  aem_string name;
+  float inverse_bind_matrix[16];
+  int32_t parent_joint_index;
+};
+
+// The joint names section starts with this, followed by the name offsets, the buckets and the null-terminated names
+struct JointNameTable
+{
+  uint32_t bucket_count; // Buckets hold a joint index + 1 or 0 when empty, collisions probe the next bucket
+};
+
+// Version 2 files follow the header with a table of contents that locates each section in the file
+#define AEM_SECTION_ALIGNMENT 16 // Sections are kept aligned to this many bytes in memory, just like in the file
+
+struct SectionTable
+{
+  uint32_t entry_count;
   uint32_t padding;
 };
 
-struct Vertex
+struct SectionEntry
 {
-  float position[3], normal[3], tangent[3], bitangent[3];
-  float uv[2];
-  int32_t joint_indices[4];
-  float joint_weights[4];
+  uint32_t section; // enum AEMModelSection, unknown sections are optional and get skipped
+  uint32_t flags;   // 0x1: Load-time section, 0x2: Page-aligned
+  uint64_t offset, size;
 };
 
 struct Animation
@@ -35,41 +74,91 @@ struct Track
   uint32_t translation_keyframe_count, rotation_keyframe_count, scale_keyframe_count;
 };
 
+enum KeyframeType
+{
+  KeyframeType_Translation,
+  KeyframeType_Rotation,
+  KeyframeType_Scale,
+  KeyframeType_Count
+};
+
 struct Keyframe
 {
   float time;
   float data[4]; // Pos: [x, y, z, 0], Rot: [x, y, z, w], Scale: [x, y, z, 0]
 };
 
+enum ModelStorage
+{
+  ModelStorage_Owned,    // The model allocated and owns its data
+  ModelStorage_Borrowed, // The model points into memory supplied and owned by the caller
+  ModelStorage_Mapped    // The model points into a file mapping that it owns
+};
+
 struct AEMModel
 {
-  FILE* fp; // File pointer that is closed when loading is done
   struct Header header;
+  uint8_t version;
+
+  struct AEMAllocator allocator;
 
   void* load_time_data; // Load-time data that is released when loading is done
   void* run_time_data;  // Run-time data that is kept around after loading is done
+  uint64_t load_time_data_size;
+
+  enum ModelStorage storage;
+  struct FileMapping mapping; // Only valid for mapped models
 
-  struct Vertex* vertex_buffer;
-  uint32_t* index_buffer;
+  uint32_t skipped_texture_level_count;
+  uint8_t* owned_image_buffer;       // Compacted image buffer with only the resident levels, freed with load-time data
+  struct AEMMesh* owned_meshes;      // Upgraded meshes of version 1 files that are loaded in place
+  uint8_t* owned_joints;             // Split up joints of version 1 files that are loaded in place
+  uint32_t* joint_order;             // Parents before children, NULL if the joints are already stored that way
+  uint64_t image_buffer_file_offset; // To stream skipped texture levels in later
+
+  uint8_t* vertex_buffer;
+  uint8_t* position_buffer;
+  uint8_t* index_buffer;
   uint8_t* image_buffer;
 
   struct AEMTexture* textures;
   struct AEMMesh* meshes;
+  uint32_t* mesh_lod_offsets;   // Of the first LOD of each mesh and the total count, NULL if the file has no LODs
+  struct AEMMeshLOD* mesh_lods; // LOD 1 onwards of each mesh, from fine to coarse
+  uint32_t* meshlet_offsets;    // Of the first meshlet of each mesh and the total count, NULL if the file has none
+  struct AEMMeshlet* meshlets;
+  struct AEMBounds* bounds; // Of the model followed by each mesh, NULL if the file has none
   struct AEMMaterial* materials;
-  struct AEMJoint* joints;
+  int32_t* joint_parent_indices;
+  float* joint_inverse_bind_matrices; // 3x4 row-major, the last row is always [0, 0, 0, 1]
+  struct JointNameTable* joint_name_table;
   struct Animation* animations;
   struct Track* tracks;
   struct Keyframe* keyframes;
 };
 
+struct AEMJointMask
+{
+  uint32_t* bits;          // One bit per joint in the model
+  uint32_t* joint_indices; // Joints in the mask in parent-first order
+  uint32_t joint_count;    // Number of joints in the mask, including the ancestors of the requested joints
+
+  struct AEMAllocator allocator;
+};
+
 struct AEMAnimationMixer
 {
   struct AEMAnimationChannel* channels;
   uint32_t channel_count;
 
-  float* joint_transforms;
+  float* joint_transforms;        // Local transforms of the last update
+  float* global_joint_transforms; // Global transforms of the last update, without the inverse bind matrices
   uint32_t joint_count;
 
+  uint32_t* keyframe_cursors; // Last keyframe looked up for each keyframe type of each joint in each channel
+
+  struct AEMAllocator allocator; // The arrays above are part of the same allocation as the mixer
+
   bool is_blending;
   uint32_t blend_target_channel_index;
   float blend_target_channel_initial_weight;
@@ -77,5 +166,17 @@ struct AEMAnimationMixer
   float blend_speed;
   enum AEMAnimationBlendMode blend_mode;
 
+  enum AEMJointTransformFormat joint_transform_format;
+
+  float update_interval; // Time between samples when throttled, 0 to sample on every update
+  float time_since_sample;
+  struct PoseLanes* sampled_poses; // The last two blended local poses when throttled, one per group of joints each
+  uint32_t sample_index;           // Which of the two samples is the current one
+  bool has_sample;
+  const struct AEMJointMask* lod_mask; // Joints outside of it are frozen, optional
+
+  struct AEMPoseCache* pose_cache;       // Optional
+  struct PoseCacheEntry** cached_poses; // One per channel, only valid during an update
+
   bool is_enabled;
 };
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+
+// Hooks for all memory that libaem allocates, e.g. to place the models and mixers of a level in an arena
+struct AEMAllocator
+{
+  void* user_data;
+  void* (*allocate)(void* user_data, size_t size); // Aligned like malloc(), NULL when out of memory
+  void (*free)(void* user_data, void* memory);     // Never called with NULL
+};
+
+// Sets the allocator for objects that are created from now on, NULL restores malloc() and free(). Objects keep the
+// allocator they were created with and are freed with it. Not thread-safe, set it before objects are created.
+void aem_set_allocator(const struct AEMAllocator* allocator);
+void aem_get_allocator(struct AEMAllocator* allocator);
@@ -4,6 +4,10 @@
 #include <stdint.h>
 
 struct AEMAnimationMixer;
+struct AEMModel;
+struct AEMAnimationThreadPool;
+struct AEMJointMask;
+struct AEMPoseCache;
 
 enum AEMAnimationMixerResult
 {
@@ -18,6 +22,14 @@ enum AEMAnimationBlendMode
   AEMAnimationBlendMode_Smoother
 };
 
+// Layout of the skinning transforms that an update writes for every joint
+enum AEMJointTransformFormat
+{
+  AEMJointTransformFormat_Matrix4x4,     // 16 floats, a column-major 4x4 matrix
+  AEMJointTransformFormat_Matrix3x4,     // 12 floats, the top three rows of the 4x4 matrix as the bottom is constant
+  AEMJointTransformFormat_DualQuaternion // 8 floats, the real then the dual part as [x, y, z, w], drops any scale
+};
+
 struct AEMAnimationChannel
 {
   uint32_t animation_index;
@@ -38,6 +50,37 @@ void aem_set_animation_mixer_blend_speed(struct AEMAnimationMixer* mixer, float
 enum AEMAnimationBlendMode aem_get_animation_mixer_blend_mode(const struct AEMAnimationMixer* mixer);
 void aem_set_animation_mixer_blend_mode(struct AEMAnimationMixer* mixer, enum AEMAnimationBlendMode blend_mode);
 
+// Defaults to 4x4 matrices
+enum AEMJointTransformFormat aem_get_animation_mixer_joint_transform_format(const struct AEMAnimationMixer* mixer);
+void aem_set_animation_mixer_joint_transform_format(struct AEMAnimationMixer* mixer,
+                                                    enum AEMJointTransformFormat joint_transform_format);
+
+// Level of detail for distant or hidden instances. A throttled mixer only samples its animations once per update
+// interval, which is 0 by default to sample on every update, and interpolates between its last two samples otherwise.
+// Its pose lags behind by up to one interval as a result.
+// Joints outside of the LOD mask, like fingers or the face, are frozen in their last pose while their parents still
+// move them around. The mask is not copied and has to stay alive while it is set.
+float aem_get_animation_mixer_update_interval(const struct AEMAnimationMixer* mixer);
+void aem_set_animation_mixer_update_interval(struct AEMAnimationMixer* mixer, float update_interval);
+
+const struct AEMJointMask* aem_get_animation_mixer_lod_mask(const struct AEMAnimationMixer* mixer);
+void aem_set_animation_mixer_lod_mask(struct AEMAnimationMixer* mixer, const struct AEMJointMask* lod_mask); // Optional
+
+// Mixers that share a pose cache sample every animation of a model at a given time only once. Channel times are rounded
+// to the time step of the cache, so instances that play in lockstep share their poses. Entries hold the poses of models
+// with up to the given number of joints, when all are taken the least recently used one is replaced. A pose cache can
+// be shared by the threads of a batched update. Clear it when a model is freed, as poses are looked up by its address.
+enum AEMAnimationMixerResult
+aem_create_pose_cache(uint32_t entry_count, uint32_t joint_count, float time_step, struct AEMPoseCache** pose_cache);
+void aem_free_pose_cache(struct AEMPoseCache* pose_cache);
+void aem_clear_pose_cache(struct AEMPoseCache* pose_cache);
+
+struct AEMPoseCache* aem_get_animation_mixer_pose_cache(const struct AEMAnimationMixer* mixer);
+void aem_set_animation_mixer_pose_cache(struct AEMAnimationMixer* mixer, struct AEMPoseCache* pose_cache); // Optional
+
+// Number of floats per joint in the given format
+uint32_t aem_get_joint_transform_size(enum AEMJointTransformFormat joint_transform_format);
+
 // For manual channel access and modification
 struct AEMAnimationChannel*
 aem_get_animation_mixer_channel(const struct AEMAnimationMixer* mixer, uint32_t channel_index);
@@ -51,7 +94,63 @@ void aem_get_animation_mixer_joint_transform(const struct AEMModel* model,
 void aem_cut_to_animation_mixer_channel(struct AEMAnimationMixer* mixer, uint32_t channel_index);
 void aem_blend_to_animation_mixer_channel(struct AEMAnimationMixer* mixer, uint32_t channel_index);
 
+// Writes the skinning transform of every joint in the joint transform format of the mixer
 void aem_update_animation(const struct AEMModel* model,
                           struct AEMAnimationMixer* mixer,
                           float delta_time,
                           float* joint_transforms);
+
+// Caps the joints that are sampled across many updates, the budget is reduced by the joints that the mixer samples.
+// A mixer that would go over the budget keeps its last pose, so update the most important instances first every frame.
+// A mixer without a pose yet always samples, using up what is left of the budget.
+void aem_update_animation_with_budget(const struct AEMModel* model,
+                                      struct AEMAnimationMixer* mixer,
+                                      float delta_time,
+                                      uint32_t* joint_budget,
+                                      float* joint_transforms);
+
+// Partial updates that only evaluate the joints in a mask, which also holds all of their ancestors. Only the joints in
+// the mask get valid joint transforms and global transforms from aem_get_animation_mixer_joint_transform.
+// A mask is created for one model and can be shared by all mixers of that model.
+enum AEMAnimationMixerResult aem_create_joint_mask(const struct AEMModel* model,
+                                                   const uint32_t* joint_indices,
+                                                   uint32_t joint_index_count,
+                                                   struct AEMJointMask** mask);
+void aem_free_joint_mask(struct AEMJointMask* mask);
+
+uint32_t aem_get_joint_mask_joint_count(const struct AEMJointMask* mask);
+
+void aem_update_animation_joints(const struct AEMModel* model,
+                                 struct AEMAnimationMixer* mixer,
+                                 float delta_time,
+                                 const struct AEMJointMask* mask,
+                                 float* joint_transforms); // Optional
+
+// Batched updates of many instances that share one model. The model is only read and can be shared by any number of
+// instances, but every instance needs its own mixer and its own joint transforms as those are written to.
+struct AEMAnimationUpdate
+{
+  struct AEMAnimationMixer* mixer;
+  float delta_time;
+  float* joint_transforms;
+};
+
+// A dispatcher runs the job for every index in [0, job_count), possibly in parallel, and returns once all are done
+typedef void (*AEMAnimationJob)(void* job_data, uint32_t job_index);
+typedef void (*AEMAnimationJobDispatcher)(void* user_data, AEMAnimationJob job, void* job_data, uint32_t job_count);
+
+// Without a dispatcher all instances are updated on the calling thread, one after another
+void aem_update_animations_batch(const struct AEMModel* model,
+                                 const struct AEMAnimationUpdate* updates,
+                                 uint32_t update_count,
+                                 AEMAnimationJobDispatcher dispatcher, // Optional
+                                 void* dispatcher_user_data);
+
+// Built-in thread pool, the calling thread of a dispatch helps out so the pool has one thread less than requested.
+// Passing 0 threads uses one per processor. A pool can only be dispatched to from one thread at a time.
+enum AEMAnimationMixerResult aem_create_animation_thread_pool(uint32_t thread_count,
+                                                              struct AEMAnimationThreadPool** thread_pool);
+void aem_free_animation_thread_pool(struct AEMAnimationThreadPool* thread_pool);
+
+// Dispatcher for the built-in thread pool, pass the thread pool as its user data
+void aem_dispatch_animation_jobs(void* thread_pool, AEMAnimationJob job, void* job_data, uint32_t job_count);
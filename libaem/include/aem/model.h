@@ -1,11 +1,25 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
-#define AEM_VERTEX_SIZE 88  // Size of an AEM vertex in bytes
-#define AEM_INDEX_SIZE 4    // Size of an AEM index in bytes
+#define AEM_VERTEX_SIZE 88  // Size of a full precision AEM vertex in bytes, see aem_get_vertex_size() for others
 #define AEM_STRING_SIZE 128 // Size of an AEM string in bytes
 
+// Sections that can be selected for loading, anything else is skipped without being allocated
+#define AEM_LOAD_GEOMETRY (1 << 0)   // Vertices, indices, meshes, mesh LODs, meshlets and bounds
+#define AEM_LOAD_MATERIALS (1 << 1)  // Image buffer, textures and materials
+#define AEM_LOAD_SKELETON (1 << 2)   // Joints and joint names
+#define AEM_LOAD_ANIMATIONS (1 << 3) // Animations, tracks and keyframes, implies the skeleton
+#define AEM_LOAD_ALL (AEM_LOAD_GEOMETRY | AEM_LOAD_MATERIALS | AEM_LOAD_SKELETON | AEM_LOAD_ANIMATIONS)
+
+// Vertex format flags, a format without any flags describes full precision vertices
+#define AEM_VERTEX_FORMAT_QUANTIZED (1 << 0)     // Octahedral normal/tangent, half UVs, uint8 joints, unorm8 weights
+#define AEM_VERTEX_FORMAT_UV_UNORM16 (1 << 1)    // Quantized UVs as unorm16 instead of half-float, for UVs in [0, 1]
+#define AEM_VERTEX_FORMAT_JOINTS_UINT16 (1 << 2) // Quantized joint indices as uint16 instead of uint8
+#define AEM_VERTEX_FORMAT_SPLIT_STREAMS (1 << 3) // Positions and skinning data in their own stream, for depth passes
+
 typedef unsigned char aem_string[AEM_STRING_SIZE];
 
 struct AEMModel;
@@ -16,7 +30,118 @@ enum AEMModelResult
   AEMModelResult_OutOfMemory,
   AEMModelResult_FileNotFound,
   AEMModelResult_InvalidFileType,
-  AEMModelResult_InvalidVersion
+  AEMModelResult_InvalidVersion,
+  AEMModelResult_TruncatedFile,
+  AEMModelResult_Cancelled
+};
+
+// Sections in the order they appear in a file, all load-time sections come before all run-time sections
+enum AEMModelSection
+{
+  AEMModelSection_VertexBuffer,
+  AEMModelSection_PositionBuffer, // Only present for split vertex formats
+  AEMModelSection_IndexBuffer,
+  AEMModelSection_ImageBuffer,
+  AEMModelSection_Textures,
+  AEMModelSection_Meshes,
+  AEMModelSection_Materials,
+  AEMModelSection_Joints,
+  AEMModelSection_Animations,
+  AEMModelSection_Tracks,
+  AEMModelSection_Keyframes,
+  AEMModelSection_JointNames, // Cold data that is only needed to look up joints by name
+  AEMModelSection_MeshLODs,   // Optional, only present if the converter generated LODs
+  AEMModelSection_Meshlets,   // Optional, only present if the converter generated meshlets
+  AEMModelSection_Bounds,     // Optional, not present in files from older converters
+  AEMModelSection_Count
+};
+
+// Callback-based reader to load models from arbitrary streams, e.g. data that is decompressed on the fly
+struct AEMReader
+{
+  void* user_data;
+  size_t (*read)(void* user_data, void* buffer, size_t size); // Returns the number of bytes actually read
+  bool (*skip)(void* user_data, size_t size);                 // Optional, unwanted sections are read otherwise
+};
+
+struct AEMModelLoadOptions
+{
+  uint32_t sections; // Combination of AEM_LOAD_* flags
+
+  // Caps the texture resolution by leaving out this many of the largest levels of each texture, the smallest level is
+  // always kept. The skipped levels can be streamed in later using their byte ranges in the file.
+  uint32_t skipped_texture_level_count;
+};
+
+// Handle of a model that is being loaded on a worker thread
+struct AEMModelLoad;
+
+enum AEMModelLoadState
+{
+  AEMModelLoadState_Loading,
+  AEMModelLoadState_Complete,
+  AEMModelLoadState_Failed
+};
+
+struct AEMModelLoadProgress
+{
+  uint32_t loaded_sections; // Bit mask of sections that can already be accessed, (1 << AEMModelSection_*)
+  uint64_t loaded_size, total_size; // In bytes, the total size is 0 until the header has been read
+};
+
+// Called on the worker thread after every chunk that has been read, it must not access the model
+typedef void (*AEMModelLoadCallback)(void* user_data, enum AEMModelSection section, uint64_t loaded_size,
+                                     uint64_t section_size);
+
+enum AEMVertexAttribute
+{
+  AEMVertexAttribute_Position,
+  AEMVertexAttribute_Normal,
+  AEMVertexAttribute_Tangent,
+  AEMVertexAttribute_Bitangent, // Not present in quantized vertices, reconstruct from normal, tangent and sign instead
+  AEMVertexAttribute_UV,
+  AEMVertexAttribute_JointIndices,
+  AEMVertexAttribute_JointWeights,
+  AEMVertexAttribute_Count
+};
+
+// Vertices are either interleaved in a single stream or split into a position stream and a stream for the rest
+enum AEMVertexStream
+{
+  AEMVertexStream_Vertices,  // See aem_get_model_vertex_buffer()
+  AEMVertexStream_Positions, // See aem_get_model_position_buffer(), positions and skinning data of split vertex formats
+  AEMVertexStream_Count
+};
+
+enum AEMVertexAttributeType
+{
+  AEMVertexAttributeType_None, // Attribute is not present
+  AEMVertexAttributeType_Float,
+  AEMVertexAttributeType_HalfFloat,
+  AEMVertexAttributeType_Int32,
+  AEMVertexAttributeType_Int16,
+  AEMVertexAttributeType_UInt16,
+  AEMVertexAttributeType_Int8,
+  AEMVertexAttributeType_UInt8
+};
+
+struct AEMVertexAttributeLayout
+{
+  enum AEMVertexAttributeType type;
+  uint32_t component_count;
+  enum AEMVertexStream stream;
+  uint32_t offset; // In bytes from the start of the vertex in its stream
+  bool normalized; // Integers are mapped to [0, 1] if unsigned or [-1, 1] if signed, otherwise they stay integers
+};
+
+// Describes how the attributes of a vertex are laid out so that renderers can set up their attribute pointers.
+// Quantized normals and tangents are octahedral-encoded in their first two components. The third component of the
+// tangent holds the sign of the bitangent, which is cross(normal, tangent) * sign.
+struct AEMVertexLayout
+{
+  uint32_t format; // Combination of AEM_VERTEX_FORMAT_* flags
+  uint32_t strides[AEMVertexStream_Count]; // In bytes, 0 for streams that are not used by the format
+  struct AEMVertexAttributeLayout attributes[AEMVertexAttribute_Count];
 };
 
 enum AEMTextureWrapMode
@@ -42,10 +167,19 @@ struct AEMTexture
   enum AEMTextureCompression compression;
 };
 
+// Meshes with less than 65536 vertices can store their indices as 16-bit
+enum AEMIndexType
+{
+  AEMIndexType_UInt32,
+  AEMIndexType_UInt16
+};
+
 struct AEMMesh
 {
-  uint32_t first_index, index_count;
+  uint32_t first_index, index_count; // In indices of the index type of the mesh
   uint32_t material_index;
+  uint32_t base_vertex;         // Added to every index of the mesh
+  enum AEMIndexType index_type; // Always 32-bit in version 1 files
 };
 
 enum AEMMaterialType
@@ -54,6 +188,33 @@ enum AEMMaterialType
   AEMMaterialType_Transparent
 };
 
+// Bounds in model space that cover the rest pose as well as every pose that the animations of the model can produce
+struct AEMBounds
+{
+  float min[3], max[3];    // Axis-aligned bounding box
+  float center[3], radius; // Bounding sphere
+};
+
+// A simplified version of a mesh that uses the same vertices, index type and base vertex, LOD 0 is the mesh itself
+struct AEMMeshLOD
+{
+  uint32_t first_index, index_count; // In indices of the index type of the mesh
+  float error;                       // Roughly how far the simplified surface strays from the full mesh, in model units
+};
+
+// A cluster of connected triangles of a mesh that can be culled on its own, the meshlets of a mesh cover its indices
+struct AEMMeshlet
+{
+  uint32_t first_index, index_count; // In indices of the index type of the mesh
+
+  float center[3], radius; // Bounding sphere
+
+  // Normal cone, all triangles face away from cameras that see the apex within the cone around the axis
+  float cone_apex[3];
+  float cone_axis[3];
+  float cone_cutoff;
+};
+
 struct AEMMaterial
 {
   uint32_t base_color_texture_index;
@@ -62,14 +223,45 @@ struct AEMMaterial
   enum AEMMaterialType type;
 };
 
-struct AEMJoint
-{
-  aem_string name;
-  float inverse_bind_matrix[16];
-  int32_t parent_joint_index;
-};
-
+// Passing NULL for the options to any of these loads everything
 enum AEMModelResult aem_load_model(const char* filename, struct AEMModel** model);
+enum AEMModelResult
+aem_load_model_with_options(const char* filename, const struct AEMModelLoadOptions* options, struct AEMModel** model);
+
+// Maps the file into memory instead of reading it, all buffers of the model point directly into the mapping. Version 1
+// files don't keep their sections aligned, they are read out of the mapping into a copy instead.
+enum AEMModelResult
+aem_load_model_mapped(const char* filename, const struct AEMModelLoadOptions* options, struct AEMModel** model);
+
+// Borrowing points the model directly into the data instead of copying it, the data then has to outlive the model.
+// Every section has to be 16-byte aligned in memory for that, so the data should start at a 16-byte aligned address
+// and be a version 2 file, otherwise it is copied as if it was not borrowed.
+enum AEMModelResult aem_load_model_from_memory(const void* data,
+                                               size_t size,
+                                               bool borrow,
+                                               const struct AEMModelLoadOptions* options,
+                                               struct AEMModel** model);
+
+enum AEMModelResult aem_load_model_from_reader(const struct AEMReader* reader,
+                                               const struct AEMModelLoadOptions* options,
+                                               struct AEMModel** model);
+
+// Asynchronous loading, reads the file in chunks on a worker thread so that the calling thread can keep going.
+// Sections that are reported as loaded by a poll can be accessed through the model while later sections are still
+// being read. The load has to be ended in any case, which waits for the worker thread and hands over the model.
+// The counts of the model are final as soon as it is available, except for the image buffer size when texture levels
+// are skipped and the joint names size of version 1 files, which are only final once their section has been loaded.
+enum AEMModelResult aem_begin_loading_model(const char* filename,
+                                            const struct AEMModelLoadOptions* options,
+                                            AEMModelLoadCallback callback, // Optional
+                                            void* user_data,
+                                            struct AEMModelLoad** load);
+enum AEMModelLoadState aem_poll_loading_model(struct AEMModelLoad* load,
+                                              struct AEMModelLoadProgress* progress); // Progress is optional
+const struct AEMModel* aem_get_loading_model(struct AEMModelLoad* load); // NULL until the header has been read
+void aem_cancel_loading_model(struct AEMModelLoad* load); // Stops after the current chunk
+enum AEMModelResult aem_end_loading_model(struct AEMModelLoad* load, struct AEMModel** model);
+
 void aem_finish_loading_model(const struct AEMModel* model);
 void aem_free_model(struct AEMModel* model);
 
@@ -77,12 +269,20 @@ void aem_print_model_info(struct AEMModel* model);
 
 void* aem_get_model_vertex_buffer(const struct AEMModel* model);
 uint32_t aem_get_model_vertex_count(const struct AEMModel* model);
+uint32_t aem_get_model_vertex_format(const struct AEMModel* model); // Combination of AEM_VERTEX_FORMAT_* flags
+void* aem_get_model_position_buffer(const struct AEMModel* model);  // NULL unless the vertex format is split
+
+void aem_get_vertex_layout(uint32_t vertex_format, struct AEMVertexLayout* layout);
+uint32_t aem_get_vertex_size(uint32_t vertex_format, enum AEMVertexStream stream); // In bytes
 
 void* aem_get_model_index_buffer(const struct AEMModel* model);
-uint32_t aem_get_model_index_count(const struct AEMModel* model);
+uint32_t aem_get_model_index_count(const struct AEMModel* model); // Of all meshes, not counting the indices of LODs
+uint64_t aem_get_model_index_buffer_size(const struct AEMModel* model); // In bytes, indices can be of mixed types
+uint32_t aem_get_index_size(enum AEMIndexType index_type);              // In bytes
 
 void* aem_get_model_image_buffer(const struct AEMModel* model);
-uint64_t aem_get_model_image_buffer_size(const struct AEMModel* model);
+uint64_t aem_get_model_image_buffer_size(const struct AEMModel* model); // Final once the image buffer has loaded
+uint64_t aem_get_model_image_buffer_file_offset(const struct AEMModel* model); // Where the image buffer is in the file
 
 const struct AEMTexture* aem_get_model_textures(const struct AEMModel* model, uint32_t* texture_count);
 
@@ -94,13 +294,62 @@ void aem_get_model_texture_level_data(const struct AEMTexture* texture,
                                       uint32_t* level_height,
                                       uint32_t* level_size);
 
+// Byte range of consecutive levels of a texture, the offset is relative to the image buffer as stored in the file
+void aem_get_model_texture_level_range(const struct AEMTexture* texture,
+                                       uint32_t first_level,
+                                       uint32_t level_count,
+                                       uint64_t* offset,
+                                       uint64_t* size);
+
+// Data of the first level of a texture that is resident in memory, all smaller levels follow directly afterwards
+const void*
+aem_get_model_texture_data(const struct AEMModel* model, const struct AEMTexture* texture, uint32_t* first_level);
+
 uint32_t aem_get_model_mesh_count(const struct AEMModel* model);
 const struct AEMMesh* aem_get_model_mesh(const struct AEMModel* model, uint32_t mesh_index);
 
+// Bounds to cull the model or one of its meshes with, NULL if the file has no bounds
+const struct AEMBounds* aem_get_model_bounds(const struct AEMModel* model);
+const struct AEMBounds* aem_get_model_mesh_bounds(const struct AEMModel* model, uint32_t mesh_index);
+
+// LODs are ordered from the full mesh to the coarsest version, meshes without generated LODs only have LOD 0
+uint32_t aem_get_model_mesh_lod_count(const struct AEMModel* model, uint32_t mesh_index);
+void aem_get_model_mesh_lod(const struct AEMModel* model,
+                            uint32_t mesh_index,
+                            uint32_t lod_index,
+                            struct AEMMeshLOD* lod);
+
+// Error of a LOD in pixels when it is seen from the given distance. The projection scale is the height of the
+// viewport in pixels divided by 2 * tan(vertical field of view / 2), and the distance has to be in model units.
+float aem_get_mesh_lod_screen_space_error(const struct AEMMeshLOD* lod, float distance, float projection_scale);
+
+// Picks the coarsest LOD of a mesh whose error on screen stays within the given number of pixels
+uint32_t aem_select_model_mesh_lod(const struct AEMModel* model,
+                                   uint32_t mesh_index,
+                                   float distance,
+                                   float projection_scale,
+                                   float max_screen_space_error);
+
+// Meshes only have meshlets if the converter generated them, otherwise the count is 0 and the meshlets are NULL
+uint32_t aem_get_model_mesh_meshlet_count(const struct AEMModel* model, uint32_t mesh_index);
+const struct AEMMeshlet* aem_get_model_mesh_meshlets(const struct AEMModel* model, uint32_t mesh_index);
+
+// Whether all triangles of a meshlet face away from a camera at the given position, which has to be in model space
+bool aem_is_meshlet_back_facing(const struct AEMMeshlet* meshlet, const float* camera_position);
+
 const struct AEMMaterial* aem_get_model_material(const struct AEMModel* model, uint32_t material_index);
 
+// The skeleton is stored as separate arrays so that traversing it only touches the data it needs
 uint32_t aem_get_model_joint_count(const struct AEMModel* model);
-struct AEMJoint* aem_get_model_joints(const struct AEMModel* model);
+const int32_t* aem_get_model_joint_parent_indices(const struct AEMModel* model); // -1 for root joints
+const float* aem_get_model_joint_inverse_bind_matrices(const struct AEMModel* model); // 3x4 row-major per joint
+void aem_get_model_joint_inverse_bind_matrix(const struct AEMModel* model,
+                                             uint32_t joint_index,
+                                             float matrix[16]); // Expanded to a 4x4 column-major matrix
+
+const char* aem_get_model_joint_name(const struct AEMModel* model, uint32_t joint_index);
+int32_t aem_find_model_joint(const struct AEMModel* model, const char* name); // -1 if there is no such joint
+uint32_t aem_hash_joint_name(const char* name); // Hash that the name lookup table of a file is built with
 
 uint32_t aem_get_model_animation_count(const struct AEMModel* model);
 const aem_string* aem_get_model_animation_name(const struct AEMModel* model, uint32_t animation_index);
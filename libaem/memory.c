@@ -0,0 +1,47 @@
+#include "memory.h"
+
+#include <stdlib.h>
+
+static void* allocate_default(void* user_data, size_t size)
+{
+  (void)user_data;
+  return malloc(size);
+}
+
+static void free_default(void* user_data, void* memory)
+{
+  (void)user_data;
+  free(memory);
+}
+
+static const struct AEMAllocator default_allocator = { NULL, allocate_default, free_default };
+static struct AEMAllocator current_allocator = { NULL, allocate_default, free_default };
+
+void aem_set_allocator(const struct AEMAllocator* allocator)
+{
+  current_allocator = allocator ? *allocator : default_allocator;
+}
+
+void aem_get_allocator(struct AEMAllocator* allocator)
+{
+  *allocator = current_allocator;
+}
+
+const struct AEMAllocator* get_current_allocator()
+{
+  return &current_allocator;
+}
+
+void* allocate_memory(const struct AEMAllocator* allocator, size_t size)
+{
+  // Some allocators return NULL for empty allocations, which would look like running out of memory
+  return allocator->allocate(allocator->user_data, size > 0 ? size : 1);
+}
+
+void free_memory(const struct AEMAllocator* allocator, void* memory)
+{
+  if (memory)
+  {
+    allocator->free(allocator->user_data, memory);
+  }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "allocator.h"
+
+#include <stdint.h>
+
+static inline uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// The allocator that new objects are created with, they keep a copy of it
+const struct AEMAllocator* get_current_allocator();
+
+void* allocate_memory(const struct AEMAllocator* allocator, size_t size);
+void free_memory(const struct AEMAllocator* allocator, void* memory); // Accepts NULL
@@ -1,105 +1,1531 @@
 #include "model.h"
 #include "common.h"
+#include "memory.h"
 
-#include <stdlib.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#define LOAD_CHUNK_SIZE (1 << 20) // Sections are read in chunks of this many bytes so that loading can be observed
+#define CURRENT_VERSION 2          // Sections are laid out in memory just like they are stored in files of this version
+
+// Gets notified while a model is being read, used for asynchronous loading
+struct LoadObserver
+{
+  void* user_data;
+  bool (*on_chunk_loaded)(void* user_data, enum AEMModelSection section, uint64_t loaded_size, uint64_t section_size);
+  void (*on_section_loaded)(void* user_data, enum AEMModelSection section);
+};
+
+static enum AEMModelResult check_id(const uint8_t id[4])
+{
+  if (id[0] != 'A' || id[1] != 'E' || id[2] != 'M')
+  {
+    return AEMModelResult_InvalidFileType;
+  }
+
+  if (id[3] != 1 && id[3] != 2)
+  {
+    return AEMModelResult_InvalidVersion;
+  }
+
+  return AEMModelResult_Success;
+}
+
+// The joints section holds the parent indices followed by the inverse bind matrices
+static uint64_t get_joint_matrices_offset(uint32_t joint_count)
+{
+  return align_up((uint64_t)joint_count * sizeof(int32_t), AEM_SECTION_ALIGNMENT);
+}
+
+static uint64_t get_joints_size(uint32_t joint_count)
+{
+  return get_joint_matrices_offset(joint_count) + (uint64_t)joint_count * 12 * sizeof(float);
+}
+
+// The mesh LODs and meshlets sections hold the offset of the first element of each mesh plus the total element count,
+// followed by the elements
+static uint64_t get_mesh_elements_offset(uint32_t mesh_count)
+{
+  return ((uint64_t)mesh_count + 1) * sizeof(uint32_t);
+}
+
+// The bounds of the model followed by those of each mesh
+static uint64_t get_bounds_size(uint32_t mesh_count)
+{
+  return ((uint64_t)mesh_count + 1) * sizeof(struct AEMBounds);
+}
+
+static uint64_t* get_optional_section_size(struct Header* header, uint32_t section)
+{
+  switch (section)
+  {
+  case AEMModelSection_MeshLODs:
+    return &header->mesh_lods_size;
+  case AEMModelSection_Meshlets:
+    return &header->meshlets_size;
+  case AEMModelSection_Bounds:
+    return &header->bounds_size;
+  default:
+    return NULL;
+  }
+}
+
+// Calculates the sizes of the sections as they are stored in a file of the given version
+static void calculate_section_sizes(const struct Header* header, uint8_t version, uint64_t* section_sizes)
+{
+  const uint32_t vertex_size = aem_get_vertex_size(header->vertex_format, AEMVertexStream_Vertices);
+  const uint32_t position_size = aem_get_vertex_size(header->vertex_format, AEMVertexStream_Positions);
+  section_sizes[AEMModelSection_VertexBuffer] = (uint64_t)header->vertex_count * vertex_size;
+  section_sizes[AEMModelSection_PositionBuffer] = (uint64_t)header->vertex_count * position_size;
+  section_sizes[AEMModelSection_IndexBuffer] = header->index_buffer_size;
+  section_sizes[AEMModelSection_ImageBuffer] = header->image_buffer_size;
+  section_sizes[AEMModelSection_Textures] = (uint64_t)header->texture_count * sizeof(struct AEMTexture);
+  section_sizes[AEMModelSection_Meshes] =
+    (uint64_t)header->mesh_count * (version == 1 ? sizeof(struct MeshV1) : sizeof(struct AEMMesh));
+  section_sizes[AEMModelSection_Materials] = (uint64_t)header->material_count * sizeof(struct AEMMaterial);
+  section_sizes[AEMModelSection_Joints] =
+    version == 1 ? (uint64_t)header->joint_count * sizeof(struct JointV1) : get_joints_size(header->joint_count);
+  section_sizes[AEMModelSection_Animations] = (uint64_t)header->animation_count * sizeof(struct Animation);
+  section_sizes[AEMModelSection_Tracks] = (uint64_t)header->track_count * sizeof(struct Track);
+  section_sizes[AEMModelSection_Keyframes] = (uint64_t)header->keyframe_count * sizeof(struct Keyframe);
+  section_sizes[AEMModelSection_JointNames] = version == 1 ? 0 : header->joint_names_size;
+  section_sizes[AEMModelSection_MeshLODs] = header->mesh_lods_size;
+  section_sizes[AEMModelSection_Meshlets] = header->meshlets_size;
+  section_sizes[AEMModelSection_Bounds] = header->bounds_size;
+}
+
+static uint64_t
+sum_section_sizes(const uint64_t* section_sizes, enum AEMModelSection first, enum AEMModelSection last)
+{
+  uint64_t size = 0;
+  for (uint32_t section = first; section <= last; ++section)
+  {
+    size += section_sizes[section];
+  }
+
+  return size;
+}
+
+// Clears the counts of all sections that should not be loaded so that the getters report them as empty
+static void apply_section_mask(struct Header* header, uint32_t sections)
+{
+  // Tracks are laid out per joint, so animations can't be used without the skeleton
+  if (sections & AEM_LOAD_ANIMATIONS)
+  {
+    sections |= AEM_LOAD_SKELETON;
+  }
+
+  if (!(sections & AEM_LOAD_GEOMETRY))
+  {
+    header->vertex_count = header->index_count = header->mesh_count = 0;
+    header->index_buffer_size = header->mesh_lods_size = header->meshlets_size = header->bounds_size = 0;
+  }
+
+  if (!(sections & AEM_LOAD_MATERIALS))
+  {
+    header->image_buffer_size = 0;
+    header->texture_count = header->material_count = 0;
+  }
+
+  if (!(sections & AEM_LOAD_SKELETON))
+  {
+    header->joint_count = 0;
+    header->joint_names_size = 0;
+  }
+
+  if (!(sections & AEM_LOAD_ANIMATIONS))
+  {
+    header->animation_count = header->track_count = header->keyframe_count = 0;
+  }
+}
+
+static void set_section_pointer(struct AEMModel* model, enum AEMModelSection section, uint8_t* pointer)
+{
+  switch (section)
+  {
+  case AEMModelSection_VertexBuffer:
+    model->vertex_buffer = pointer;
+    break;
+  case AEMModelSection_PositionBuffer:
+    model->position_buffer = pointer;
+    break;
+  case AEMModelSection_IndexBuffer:
+    model->index_buffer = pointer;
+    break;
+  case AEMModelSection_ImageBuffer:
+    model->image_buffer = pointer;
+    break;
+  case AEMModelSection_Textures:
+    model->textures = (struct AEMTexture*)pointer;
+    break;
+  case AEMModelSection_Meshes:
+    model->meshes = (struct AEMMesh*)pointer;
+    break;
+  case AEMModelSection_Materials:
+    model->materials = (struct AEMMaterial*)pointer;
+    break;
+  case AEMModelSection_Joints:
+    model->joint_parent_indices = (int32_t*)pointer;
+    model->joint_inverse_bind_matrices =
+      pointer ? (float*)(pointer + get_joint_matrices_offset(model->header.joint_count)) : NULL;
+    break;
+  case AEMModelSection_Animations:
+    model->animations = (struct Animation*)pointer;
+    break;
+  case AEMModelSection_Tracks:
+    model->tracks = (struct Track*)pointer;
+    break;
+  case AEMModelSection_Keyframes:
+    model->keyframes = (struct Keyframe*)pointer;
+    break;
+  case AEMModelSection_JointNames:
+    model->joint_name_table = (struct JointNameTable*)pointer;
+    break;
+  case AEMModelSection_MeshLODs:
+    model->mesh_lod_offsets = (uint32_t*)pointer;
+    model->mesh_lods =
+      pointer ? (struct AEMMeshLOD*)(pointer + get_mesh_elements_offset(model->header.mesh_count)) : NULL;
+    break;
+  case AEMModelSection_Bounds:
+    model->bounds = (struct AEMBounds*)pointer;
+    break;
+  case AEMModelSection_Meshlets:
+    model->meshlet_offsets = (uint32_t*)pointer;
+    model->meshlets =
+      pointer ? (struct AEMMeshlet*)(pointer + get_mesh_elements_offset(model->header.mesh_count)) : NULL;
+    break;
+  default:
+    break;
+  }
+}
+
+static struct AEMModelLoadOptions resolve_load_options(const struct AEMModelLoadOptions* options)
+{
+  if (options)
+  {
+    return *options;
+  }
+
+  const struct AEMModelLoadOptions default_options = { AEM_LOAD_ALL, 0 };
+  return default_options;
+}
+
+static uint32_t get_first_resident_texture_level(const struct AEMModel* model, const struct AEMTexture* texture)
+{
+  const uint32_t level_count = aem_get_model_texture_level_count(texture->width, texture->height);
+  return model->skipped_texture_level_count < level_count ? model->skipped_texture_level_count : level_count - 1;
+}
+
+// Copies only the resident levels of each texture into a new, tightly packed image buffer in texture order
+static bool compact_image_buffer(struct AEMModel* model, const uint8_t* source_image_buffer)
+{
+  uint64_t compacted_size = 0;
+  for (uint32_t texture_index = 0; texture_index < model->header.texture_count; ++texture_index)
+  {
+    const struct AEMTexture* texture = &model->textures[texture_index];
+    const uint32_t first_level = get_first_resident_texture_level(model, texture);
+    const uint32_t level_count = aem_get_model_texture_level_count(texture->width, texture->height);
+
+    uint64_t offset, size;
+    aem_get_model_texture_level_range(texture, first_level, level_count - first_level, &offset, &size);
+    compacted_size += size;
+  }
+
+  uint8_t* compacted_image_buffer = allocate_memory(&model->allocator, compacted_size);
+  if (compacted_size > 0 && !compacted_image_buffer)
+  {
+    return false;
+  }
+
+  uint8_t* destination = compacted_image_buffer;
+  for (uint32_t texture_index = 0; texture_index < model->header.texture_count; ++texture_index)
+  {
+    const struct AEMTexture* texture = &model->textures[texture_index];
+    const uint32_t first_level = get_first_resident_texture_level(model, texture);
+    const uint32_t level_count = aem_get_model_texture_level_count(texture->width, texture->height);
+
+    uint64_t offset, size;
+    aem_get_model_texture_level_range(texture, first_level, level_count - first_level, &offset, &size);
+    memcpy(destination, source_image_buffer + offset, size);
+    destination += size;
+  }
+
+  // Asynchronous loads only report the image buffer as loaded after this, which is when its size becomes final
+  model->image_buffer = model->owned_image_buffer = compacted_image_buffer;
+  model->header.image_buffer_size = compacted_size;
+
+  return true;
+}
+
+static bool skip_reader(const struct AEMReader* reader, uint64_t size)
+{
+  if (reader->skip)
+  {
+    return reader->skip(reader->user_data, size);
+  }
+
+  // Fall back to reading the data into a scratch buffer for readers that can't skip
+  uint8_t scratch[4096];
+  while (size > 0)
+  {
+    const size_t chunk_size = size < sizeof(scratch) ? (size_t)size : sizeof(scratch);
+    if (reader->read(reader->user_data, scratch, chunk_size) != chunk_size)
+    {
+      return false;
+    }
+
+    size -= chunk_size;
+  }
+
+  return true;
+}
+
+static size_t read_file(void* user_data, void* buffer, size_t size)
+{
+  return fread(buffer, 1, size, (FILE*)user_data);
+}
+
+static bool skip_file(void* user_data, size_t size)
+{
+#ifdef _WIN32
+  return _fseeki64((FILE*)user_data, (__int64)size, SEEK_CUR) == 0;
+#else
+  return fseeko((FILE*)user_data, (off_t)size, SEEK_CUR) == 0;
+#endif
+}
+
+struct MemoryReader
+{
+  const uint8_t* data;
+  size_t size, position;
+};
+
+static size_t read_memory(void* user_data, void* buffer, size_t size)
+{
+  struct MemoryReader* memory_reader = (struct MemoryReader*)user_data;
+
+  const size_t remaining_size = memory_reader->size - memory_reader->position;
+  if (size > remaining_size)
+  {
+    size = remaining_size;
+  }
+
+  memcpy(buffer, memory_reader->data + memory_reader->position, size);
+  memory_reader->position += size;
+
+  return size;
+}
+
+static bool skip_memory(void* user_data, size_t size)
+{
+  struct MemoryReader* memory_reader = (struct MemoryReader*)user_data;
+
+  if (size > memory_reader->size - memory_reader->position)
+  {
+    return false;
+  }
+
+  memory_reader->position += size;
+  return true;
+}
+
+// Models keep the allocator they were created with, so they are freed with it even if another one is set by then
+static struct AEMModel* allocate_model()
+{
+  const struct AEMAllocator* allocator = get_current_allocator();
+  struct AEMModel* model = allocate_memory(allocator, sizeof(struct AEMModel));
+  if (model)
+  {
+    model->allocator = *allocator;
+  }
+
+  return model;
+}
+
+static void free_model_data(struct AEMModel* model)
+{
+  free_memory(&model->allocator, model->load_time_data);
+  free_memory(&model->allocator, model->run_time_data);
+  free_memory(&model->allocator, model->owned_image_buffer);
+  free_memory(&model->allocator, model->joint_order);
+}
+
+static enum AEMModelResult read_section(const struct AEMReader* reader,
+                                        enum AEMModelSection section,
+                                        uint8_t* destination,
+                                        uint64_t size,
+                                        const struct LoadObserver* observer)
+{
+  uint64_t loaded_size = 0;
+  while (loaded_size < size)
+  {
+    const uint64_t remaining_size = size - loaded_size;
+    const size_t chunk_size = remaining_size < LOAD_CHUNK_SIZE ? (size_t)remaining_size : LOAD_CHUNK_SIZE;
+    if (reader->read(reader->user_data, destination + loaded_size, chunk_size) != chunk_size)
+    {
+      return AEMModelResult_TruncatedFile;
+    }
+
+    loaded_size += chunk_size;
+
+    if (observer && !observer->on_chunk_loaded(observer->user_data, section, loaded_size, size))
+    {
+      return AEMModelResult_Cancelled;
+    }
+  }
+
+  return AEMModelResult_Success;
+}
+
+// Expands version 1 meshes back to front, so that they can be upgraded in place
+static void upgrade_meshes(const void* source_meshes, struct AEMMesh* meshes, uint32_t mesh_count)
+{
+  for (uint32_t mesh_index = mesh_count; mesh_index-- > 0;)
+  {
+    struct MeshV1 source_mesh;
+    memcpy(&source_mesh, (const uint8_t*)source_meshes + mesh_index * sizeof(struct MeshV1), sizeof(source_mesh));
+
+    struct AEMMesh* mesh = &meshes[mesh_index];
+    mesh->first_index = source_mesh.first_index;
+    mesh->index_count = source_mesh.index_count;
+    mesh->material_index = source_mesh.material_index;
+    mesh->base_vertex = 0;
+    mesh->index_type = AEMIndexType_UInt32;
+  }
+}
+
+static uint32_t* get_joint_name_offsets(const struct JointNameTable* joint_name_table)
+{
+  return (uint32_t*)(joint_name_table + 1);
+}
+
+static uint32_t* get_joint_name_buckets(const struct JointNameTable* joint_name_table, uint32_t joint_count)
+{
+  return get_joint_name_offsets(joint_name_table) + joint_count;
+}
+
+static char* get_joint_name_strings(const struct JointNameTable* joint_name_table, uint32_t joint_count)
+{
+  return (char*)(get_joint_name_buckets(joint_name_table, joint_count) + joint_name_table->bucket_count);
+}
+
+// Version 1 names are fixed-size strings, so the size of the joint names section is only known once they are packed
+static uint64_t get_max_joint_names_size(uint32_t joint_count)
+{
+  if (joint_count == 0)
+  {
+    return 0;
+  }
+
+  return sizeof(struct JointNameTable) + (uint64_t)joint_count * (3 * sizeof(uint32_t) + AEM_STRING_SIZE);
+}
+
+// Splits version 1 joints into a joints and a joint names section, returns the size of the latter
+static uint64_t upgrade_joints(const void* source_joints, uint32_t joint_count, uint8_t* joints, uint8_t* joint_names)
+{
+  int32_t* parent_indices = (int32_t*)joints;
+  float* inverse_bind_matrices = (float*)(joints + get_joint_matrices_offset(joint_count));
+
+  struct JointNameTable* joint_name_table = (struct JointNameTable*)joint_names;
+  joint_name_table->bucket_count = joint_count * 2; // Keeps the probe sequences short
+  uint32_t* name_offsets = get_joint_name_offsets(joint_name_table);
+  uint32_t* buckets = get_joint_name_buckets(joint_name_table, joint_count);
+  char* names = get_joint_name_strings(joint_name_table, joint_count);
+  memset(buckets, 0, sizeof(*buckets) * joint_name_table->bucket_count);
+
+  uint32_t name_offset = 0;
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    struct JointV1 source_joint;
+    memcpy(&source_joint, (const uint8_t*)source_joints + joint_index * sizeof(struct JointV1), sizeof(source_joint));
+
+    parent_indices[joint_index] = source_joint.parent_joint_index;
+
+    // Drop the last row of the column-major matrix, it is always [0, 0, 0, 1] for the affine transforms of joints
+    float* inverse_bind_matrix = &inverse_bind_matrices[joint_index * 12];
+    for (uint32_t row = 0; row < 3; ++row)
+    {
+      for (uint32_t column = 0; column < 4; ++column)
+      {
+        inverse_bind_matrix[row * 4 + column] = source_joint.inverse_bind_matrix[column * 4 + row];
+      }
+    }
+
+    const size_t name_length = strnlen((const char*)source_joint.name, AEM_STRING_SIZE - 1);
+    memcpy(&names[name_offset], source_joint.name, name_length);
+    names[name_offset + name_length] = '\0';
+
+    uint32_t bucket_index = aem_hash_joint_name(&names[name_offset]) % joint_name_table->bucket_count;
+    while (buckets[bucket_index] != 0)
+    {
+      bucket_index = (bucket_index + 1) % joint_name_table->bucket_count;
+    }
+
+    buckets[bucket_index] = joint_index + 1;
+    name_offsets[joint_index] = name_offset;
+    name_offset += (uint32_t)name_length + 1;
+  }
+
+  return (uint64_t)((uint8_t*)&names[name_offset] - joint_names);
+}
+
+// Makes sure that looking up joints by name can never read past the end of the joint names section
+static bool check_joint_name_table(const struct JointNameTable* joint_name_table, uint32_t joint_count, uint64_t size)
+{
+  if (size < sizeof(*joint_name_table) || joint_name_table->bucket_count == 0)
+  {
+    return false;
+  }
+
+  const uint64_t names_offset =
+    sizeof(*joint_name_table) + ((uint64_t)joint_count + joint_name_table->bucket_count) * sizeof(uint32_t);
+  if (names_offset >= size)
+  {
+    return false;
+  }
+
+  const uint64_t names_size = size - names_offset;
+  const char* names = get_joint_name_strings(joint_name_table, joint_count);
+  if (names[names_size - 1] != '\0')
+  {
+    return false;
+  }
+
+  const uint32_t* name_offsets = get_joint_name_offsets(joint_name_table);
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    if (name_offsets[joint_index] >= names_size)
+    {
+      return false;
+    }
+  }
+
+  const uint32_t* buckets = get_joint_name_buckets(joint_name_table, joint_count);
+  for (uint32_t bucket_index = 0; bucket_index < joint_name_table->bucket_count; ++bucket_index)
+  {
+    if (buckets[bucket_index] > joint_count)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Makes sure that looking up the LODs or meshlets of a mesh can never read past the end of their section
+static bool
+check_mesh_elements(const uint32_t* element_offsets, uint32_t mesh_count, uint64_t element_size, uint64_t size)
+{
+  const uint64_t elements_offset = get_mesh_elements_offset(mesh_count);
+  if (size < elements_offset || element_offsets[0] != 0)
+  {
+    return false;
+  }
+
+  for (uint32_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+  {
+    if (element_offsets[mesh_index] > element_offsets[mesh_index + 1])
+    {
+      return false;
+    }
+  }
+
+  return elements_offset + (uint64_t)element_offsets[mesh_count] * element_size == size;
+}
+
+static uint64_t get_mesh_element_size(enum AEMModelSection section)
+{
+  return section == AEMModelSection_MeshLODs ? sizeof(struct AEMMeshLOD) : sizeof(struct AEMMeshlet);
+}
+
+// Older files don't always store parents before their children, those get an order to evaluate the joints in instead
+static enum AEMModelResult order_joints(struct AEMModel* model)
+{
+  const uint32_t joint_count = model->header.joint_count;
+  const int32_t* parent_indices = model->joint_parent_indices;
+
+  bool parents_first = true;
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    if (parent_indices[joint_index] >= (int32_t)joint_count)
+    {
+      return AEMModelResult_InvalidFileType;
+    }
+
+    parents_first &= parent_indices[joint_index] < (int32_t)joint_index;
+  }
+
+  if (parents_first)
+  {
+    return AEMModelResult_Success;
+  }
+
+  // Counting sort by depth in the hierarchy, which puts every parent before its children
+  uint32_t* depths = allocate_memory(&model->allocator, sizeof(uint32_t) * (2 * joint_count + 1));
+  model->joint_order = allocate_memory(&model->allocator, sizeof(uint32_t) * joint_count);
+  if (!depths || !model->joint_order)
+  {
+    free_memory(&model->allocator, depths);
+    free_memory(&model->allocator, model->joint_order);
+    model->joint_order = NULL;
+    return AEMModelResult_OutOfMemory;
+  }
+
+  uint32_t* depth_offsets = &depths[joint_count];
+  memset(depth_offsets, 0, sizeof(uint32_t) * (joint_count + 1));
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    uint32_t depth = 0;
+    for (int32_t parent_index = parent_indices[joint_index]; parent_index >= 0;
+         parent_index = parent_indices[parent_index])
+    {
+      // A joint can't be deeper than there are joints unless the hierarchy has a cycle
+      if (++depth >= joint_count)
+      {
+        free_memory(&model->allocator, depths);
+        free_memory(&model->allocator, model->joint_order);
+        model->joint_order = NULL;
+        return AEMModelResult_InvalidFileType;
+      }
+    }
+
+    depths[joint_index] = depth;
+    ++depth_offsets[depth + 1];
+  }
+
+  for (uint32_t depth = 1; depth < joint_count; ++depth)
+  {
+    depth_offsets[depth] += depth_offsets[depth - 1];
+  }
+
+  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
+  {
+    model->joint_order[depth_offsets[depths[joint_index]]++] = joint_index;
+  }
+
+  free_memory(&model->allocator, depths);
+  return AEMModelResult_Success;
+}
+
+// Reads the ID, header and table of contents and locates all sections in the file, version 1 files have no table of
+// contents and store their sections back to back right after the header
+static enum AEMModelResult read_header(const struct AEMReader* reader,
+                                       struct Header* header,
+                                       uint8_t* version,
+                                       uint64_t* section_offsets,
+                                       uint64_t* header_size)
+{
+  // Check ID and version number
+  uint8_t id[4];
+  {
+    if (reader->read(reader->user_data, id, sizeof(id)) != sizeof(id))
+    {
+      return AEMModelResult_TruncatedFile;
+    }
+
+    const enum AEMModelResult result = check_id(id);
+    if (result != AEMModelResult_Success)
+    {
+      return result;
+    }
+  }
+
+  *version = id[3];
+
+  // Header, which is shorter in version 1
+  {
+    const size_t size =
+      *version == 1 ? offsetof(struct Header, index_buffer_size) : offsetof(struct Header, mesh_lods_size);
+    if (reader->read(reader->user_data, header, size) != size)
+    {
+      return AEMModelResult_TruncatedFile;
+    }
+
+    // Until the table of contents says otherwise
+    header->mesh_lods_size = header->meshlets_size = header->bounds_size = 0;
+
+    if (*version == 1)
+    {
+      header->vertex_format = 0;
+      header->index_buffer_size = (uint64_t)header->index_count * aem_get_index_size(AEMIndexType_UInt32);
+      header->joint_names_size = get_max_joint_names_size(header->joint_count); // Until the names are packed
+    }
+
+    *header_size = sizeof(id) + size;
+  }
+
+  uint64_t section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(header, *version, section_sizes);
+
+  if (*version == 1)
+  {
+    uint64_t offset = *header_size;
+    for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+    {
+      section_offsets[section] = offset;
+      offset += section_sizes[section];
+    }
+
+    return AEMModelResult_Success;
+  }
+
+  // Table of contents
+  struct SectionTable section_table;
+  if (reader->read(reader->user_data, &section_table, sizeof(section_table)) != sizeof(section_table))
+  {
+    return AEMModelResult_TruncatedFile;
+  }
+
+  *header_size += sizeof(section_table);
+
+  bool found_sections[AEMModelSection_Count] = { false };
+  for (uint32_t entry_index = 0; entry_index < section_table.entry_count; ++entry_index)
+  {
+    struct SectionEntry entry;
+    if (reader->read(reader->user_data, &entry, sizeof(entry)) != sizeof(entry))
+    {
+      return AEMModelResult_TruncatedFile;
+    }
+
+    *header_size += sizeof(entry);
+
+    // Sections that are unknown to this version of the library are optional and can be ignored
+    if (entry.section >= AEMModelSection_Count)
+    {
+      continue;
+    }
+
+    // Optional sections are not counted in the header, so their size can only be taken from the table of contents
+    uint64_t* optional_section_size = get_optional_section_size(header, entry.section);
+    if (optional_section_size && !found_sections[entry.section])
+    {
+      *optional_section_size = section_sizes[entry.section] = entry.size;
+    }
+
+    // The counts in the header and the sizes in the table of contents need to agree
+    if (found_sections[entry.section] || entry.size != section_sizes[entry.section])
+    {
+      return AEMModelResult_InvalidFileType;
+    }
+
+    found_sections[entry.section] = true;
+    section_offsets[entry.section] = entry.offset;
+  }
+
+  // Bounds are optional as a whole, but if they are there they have to cover the model and every mesh
+  if (header->bounds_size > 0 && header->bounds_size != get_bounds_size(header->mesh_count))
+  {
+    return AEMModelResult_InvalidFileType;
+  }
+
+  for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+  {
+    if (!found_sections[section])
+    {
+      if (section_sizes[section] > 0)
+      {
+        return AEMModelResult_InvalidFileType;
+      }
+
+      section_offsets[section] = *header_size;
+    }
+    else if (section_sizes[section] > 0 && section_offsets[section] < *header_size)
+    {
+      return AEMModelResult_InvalidFileType;
+    }
+  }
+
+  return AEMModelResult_Success;
+}
+
+static enum AEMModelResult load_model_from_reader(const struct AEMReader* reader,
+                                                  const struct AEMModelLoadOptions* options,
+                                                  const struct LoadObserver* observer, // Optional
+                                                  struct AEMModel* model)
+{
+  model->storage = ModelStorage_Owned;
+  model->load_time_data = model->run_time_data = NULL;
+  model->owned_image_buffer = NULL;
+  model->owned_meshes = NULL;
+  model->owned_joints = NULL;
+  model->joint_order = NULL;
+  model->joint_name_table = NULL; // Not visited for version 1 files
+  model->skipped_texture_level_count = options->skipped_texture_level_count;
+
+  uint64_t section_offsets[AEMModelSection_Count], header_size;
+  {
+    const enum AEMModelResult result = read_header(reader, &model->header, &model->version, section_offsets, &header_size);
+    if (result != AEMModelResult_Success)
+    {
+      return result;
+    }
+  }
+
+  uint64_t file_section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(&model->header, model->version, file_section_sizes);
+
+  apply_section_mask(&model->header, options->sections);
+  model->image_buffer_file_offset = section_offsets[AEMModelSection_ImageBuffer];
+
+  uint64_t section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(&model->header, model->version, section_sizes);
+
+  // Sections of older versions are upgraded while loading, so they can take up more memory than in the file
+  uint64_t memory_section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(&model->header, CURRENT_VERSION, memory_section_sizes);
+
+  // When skipping texture levels the full image buffer is only held temporarily until it has been compacted
+  const bool compact = model->skipped_texture_level_count > 0 && section_sizes[AEMModelSection_ImageBuffer] > 0;
+  uint8_t* full_image_buffer = NULL;
+  if (compact)
+  {
+    full_image_buffer = allocate_memory(&model->allocator, section_sizes[AEMModelSection_ImageBuffer]);
+    if (!full_image_buffer)
+    {
+      return AEMModelResult_OutOfMemory;
+    }
+  }
+
+  // Lay out the requested sections in a load-time and a run-time block, keeping them aligned just like in the file
+  uint64_t memory_offsets[AEMModelSection_Count];
+  uint64_t run_time_data_size = 0;
+  model->load_time_data_size = 0;
+  for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+  {
+    memory_offsets[section] = 0;
+    if (memory_section_sizes[section] == 0 || (section == AEMModelSection_ImageBuffer && compact))
+    {
+      continue;
+    }
+
+    uint64_t* block_size = section <= AEMModelSection_Textures ? &model->load_time_data_size : &run_time_data_size;
+    memory_offsets[section] = *block_size = align_up(*block_size, AEM_SECTION_ALIGNMENT);
+    *block_size += memory_section_sizes[section];
+  }
+
+  if (model->load_time_data_size > 0)
+  {
+    model->load_time_data = allocate_memory(&model->allocator, model->load_time_data_size);
+    if (!model->load_time_data)
+    {
+      free_memory(&model->allocator, full_image_buffer);
+      return AEMModelResult_OutOfMemory;
+    }
+  }
+
+  if (run_time_data_size > 0)
+  {
+    model->run_time_data = allocate_memory(&model->allocator, run_time_data_size);
+    if (!model->run_time_data)
+    {
+      free_memory(&model->allocator, full_image_buffer);
+      free_model_data(model);
+      return AEMModelResult_OutOfMemory;
+    }
+  }
+
+  // Visit the sections in the order in which they are stored in the file
+  uint32_t section_order[AEMModelSection_Count];
+  for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+  {
+    uint32_t order_index = section;
+    while (order_index > 0 && section_offsets[section_order[order_index - 1]] > section_offsets[section])
+    {
+      section_order[order_index] = section_order[order_index - 1];
+      --order_index;
+    }
+
+    section_order[order_index] = section;
+  }
+
+  // Read the requested sections and skip over the rest
+  uint64_t position = header_size;
+  for (uint32_t order_index = 0; order_index < AEMModelSection_Count; ++order_index)
+  {
+    const enum AEMModelSection section = section_order[order_index];
+
+    // Version 1 files have no joint names section, the names are split off the joints instead
+    if (section == AEMModelSection_JointNames && model->version == 1)
+    {
+      if (observer)
+      {
+        observer->on_section_loaded(observer->user_data, section);
+      }
+
+      continue;
+    }
+
+    if (file_section_sizes[section] == 0 || section_sizes[section] == 0)
+    {
+      set_section_pointer(model, section, NULL);
+    }
+
+    if (file_section_sizes[section] == 0)
+    {
+      if (observer)
+      {
+        observer->on_section_loaded(observer->user_data, section);
+      }
+
+      continue;
+    }
+
+    // Sections can only be streamed if they don't overlap
+    if (section_offsets[section] < position)
+    {
+      free_memory(&model->allocator, full_image_buffer);
+      free_model_data(model);
+      return AEMModelResult_InvalidFileType;
+    }
+
+    if (section_offsets[section] > position && !skip_reader(reader, section_offsets[section] - position))
+    {
+      free_memory(&model->allocator, full_image_buffer);
+      free_model_data(model);
+      return AEMModelResult_TruncatedFile;
+    }
+
+    position = section_offsets[section] + file_section_sizes[section];
+
+    if (section_sizes[section] == 0)
+    {
+      if (!skip_reader(reader, file_section_sizes[section]))
+      {
+        free_memory(&model->allocator, full_image_buffer);
+        free_model_data(model);
+        return AEMModelResult_TruncatedFile;
+      }
+
+      if (observer)
+      {
+        observer->on_section_loaded(observer->user_data, section);
+      }
+
+      continue;
+    }
+
+    uint8_t* destination = full_image_buffer;
+    if (section != AEMModelSection_ImageBuffer || !compact)
+    {
+      uint8_t* block = section <= AEMModelSection_Textures ? model->load_time_data : model->run_time_data;
+      destination = block + memory_offsets[section];
+    }
+
+    // Version 1 joints are read into a scratch buffer, they shrink when they are split up
+    const bool split_joints = section == AEMModelSection_Joints && model->version == 1;
+    uint8_t* source_joints = NULL;
+    if (split_joints)
+    {
+      source_joints = allocate_memory(&model->allocator, section_sizes[section]);
+      if (!source_joints)
+      {
+        free_memory(&model->allocator, full_image_buffer);
+        free_model_data(model);
+        return AEMModelResult_OutOfMemory;
+      }
+    }
+
+    const enum AEMModelResult result =
+      read_section(reader, section, split_joints ? source_joints : destination, section_sizes[section], observer);
+    if (result != AEMModelResult_Success)
+    {
+      free_memory(&model->allocator, source_joints);
+      free_memory(&model->allocator, full_image_buffer);
+      free_model_data(model);
+      return result;
+    }
+
+    if (section == AEMModelSection_Meshes && model->version == 1)
+    {
+      upgrade_meshes(destination, (struct AEMMesh*)destination, model->header.mesh_count);
+    }
+
+    if (split_joints)
+    {
+      // Asynchronous loads publish the header before this, the packed size is final once the names are reported
+      uint8_t* joint_names = (uint8_t*)model->run_time_data + memory_offsets[AEMModelSection_JointNames];
+      model->header.joint_names_size =
+        upgrade_joints(source_joints, model->header.joint_count, destination, joint_names);
+      set_section_pointer(model, AEMModelSection_JointNames, joint_names);
+      free_memory(&model->allocator, source_joints);
+    }
+
+    const struct JointNameTable* joint_name_table = (const struct JointNameTable*)destination;
+    if ((section == AEMModelSection_JointNames &&
+         !check_joint_name_table(joint_name_table, model->header.joint_count, section_sizes[section])) ||
+        ((section == AEMModelSection_MeshLODs || section == AEMModelSection_Meshlets) &&
+         !check_mesh_elements((const uint32_t*)destination, model->header.mesh_count, get_mesh_element_size(section),
+                              section_sizes[section])))
+    {
+      free_memory(&model->allocator, full_image_buffer);
+      free_model_data(model);
+      return AEMModelResult_InvalidFileType;
+    }
+
+    set_section_pointer(model, section, destination);
+
+    if (section == AEMModelSection_Joints)
+    {
+      const enum AEMModelResult order_result = order_joints(model);
+      if (order_result != AEMModelResult_Success)
+      {
+        free_memory(&model->allocator, full_image_buffer);
+        free_model_data(model);
+        return order_result;
+      }
+    }
+
+    // A compacted image buffer is only ready once the textures describing it have been read as well
+    if (observer && !(section == AEMModelSection_ImageBuffer && compact))
+    {
+      observer->on_section_loaded(observer->user_data, section);
+    }
+  }
+
+  if (compact)
+  {
+    const bool compacted = compact_image_buffer(model, full_image_buffer);
+    free_memory(&model->allocator, full_image_buffer);
+
+    if (!compacted)
+    {
+      free_model_data(model);
+      return AEMModelResult_OutOfMemory;
+    }
+
+    if (observer)
+    {
+      observer->on_section_loaded(observer->user_data, AEMModelSection_ImageBuffer);
+    }
+  }
+
+  return AEMModelResult_Success;
+}
+
+// Sections can only be used in place if they are aligned like the ones loaded by a reader, which is not the case for a
+// buffer at an odd address or for version 1 files, whose sections are not padded. Errors are left to the caller.
+static bool are_sections_aligned(const uint8_t* data, uint64_t size)
+{
+  struct Header header;
+  uint8_t version;
+  uint64_t section_offsets[AEMModelSection_Count], header_size;
+  {
+    struct MemoryReader memory_reader = { data, size, 0 };
+    const struct AEMReader reader = { &memory_reader, read_memory, skip_memory };
+    if (read_header(&reader, &header, &version, section_offsets, &header_size) != AEMModelResult_Success)
+    {
+      return true;
+    }
+  }
+
+  uint64_t section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(&header, version, section_sizes);
+
+  for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+  {
+    if (section_sizes[section] > 0 && ((uintptr_t)data + section_offsets[section]) % AEM_SECTION_ALIGNMENT != 0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Points the model directly into a complete file image in memory without copying anything
+static enum AEMModelResult
+load_model_in_place(uint8_t* data, uint64_t size, const struct AEMModelLoadOptions* options, struct AEMModel* model)
+{
+  model->storage = ModelStorage_Borrowed;
+  model->load_time_data = model->run_time_data = NULL;
+  model->owned_image_buffer = NULL;
+  model->owned_meshes = NULL;
+  model->owned_joints = NULL;
+  model->joint_order = NULL;
+  model->skipped_texture_level_count = options->skipped_texture_level_count;
+
+  uint64_t section_offsets[AEMModelSection_Count], header_size;
+  {
+    struct MemoryReader memory_reader = { data, size, 0 };
+    const struct AEMReader reader = { &memory_reader, read_memory, skip_memory };
+    const enum AEMModelResult result = read_header(&reader, &model->header, &model->version, section_offsets, &header_size);
+    if (result != AEMModelResult_Success)
+    {
+      return result;
+    }
+  }
+
+  uint64_t file_section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(&model->header, model->version, file_section_sizes);
+
+  // Make sure that the data is not truncated before pointing into it
+  for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+  {
+    if (section_offsets[section] > size || file_section_sizes[section] > size - section_offsets[section])
+    {
+      return AEMModelResult_TruncatedFile;
+    }
+  }
+
+  apply_section_mask(&model->header, options->sections);
+  model->image_buffer_file_offset = section_offsets[AEMModelSection_ImageBuffer];
+
+  uint64_t section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(&model->header, model->version, section_sizes);
+
+  for (uint32_t section = 0; section < AEMModelSection_Count; ++section)
+  {
+    set_section_pointer(model, section, section_sizes[section] > 0 ? data + section_offsets[section] : NULL);
+  }
+
+  const uint32_t mesh_count = model->header.mesh_count;
+  if ((model->mesh_lod_offsets && !check_mesh_elements(model->mesh_lod_offsets, mesh_count, sizeof(struct AEMMeshLOD),
+                                                       section_sizes[AEMModelSection_MeshLODs])) ||
+      (model->meshlet_offsets && !check_mesh_elements(model->meshlet_offsets, mesh_count, sizeof(struct AEMMeshlet),
+                                                      section_sizes[AEMModelSection_Meshlets])))
+  {
+    return AEMModelResult_InvalidFileType;
+  }
+
+  // Version 1 meshes don't fit into the file data once they are upgraded, so they get a copy
+  if (model->version == 1 && model->meshes)
+  {
+    model->owned_meshes = allocate_memory(&model->allocator, sizeof(struct AEMMesh) * model->header.mesh_count);
+    if (!model->owned_meshes)
+    {
+      return AEMModelResult_OutOfMemory;
+    }
+
+    upgrade_meshes(model->meshes, model->owned_meshes, model->header.mesh_count);
+    model->meshes = model->owned_meshes;
+  }
+
+  // Version 1 joints are split up into a copy as well
+  if (model->version == 1 && model->joint_parent_indices)
+  {
+    const uint64_t joints_size = align_up(get_joints_size(model->header.joint_count), AEM_SECTION_ALIGNMENT);
+    model->owned_joints = allocate_memory(&model->allocator, joints_size + model->header.joint_names_size);
+    if (!model->owned_joints)
+    {
+      free_memory(&model->allocator, model->owned_meshes);
+      return AEMModelResult_OutOfMemory;
+    }
+
+    const uint8_t* source_joints = (const uint8_t*)model->joint_parent_indices;
+    uint8_t* joint_names = model->owned_joints + joints_size;
+    model->header.joint_names_size =
+      upgrade_joints(source_joints, model->header.joint_count, model->owned_joints, joint_names);
+    set_section_pointer(model, AEMModelSection_Joints, model->owned_joints);
+    set_section_pointer(model, AEMModelSection_JointNames, joint_names);
+  }
+  else if (model->joint_name_table &&
+           !check_joint_name_table(model->joint_name_table, model->header.joint_count,
+                                   section_sizes[AEMModelSection_JointNames]))
+  {
+    free_memory(&model->allocator, model->owned_meshes);
+    return AEMModelResult_InvalidFileType;
+  }
+
+  if (model->joint_parent_indices)
+  {
+    const enum AEMModelResult result = order_joints(model);
+    if (result != AEMModelResult_Success)
+    {
+      free_memory(&model->allocator, model->owned_meshes);
+      free_memory(&model->allocator, model->owned_joints);
+      return result;
+    }
+  }
+
+  // The load-time data spans all load-time sections in the file, including the ones that were not requested
+  {
+    uint64_t load_time_data_begin = UINT64_MAX, load_time_data_end = 0;
+    for (uint32_t section = AEMModelSection_VertexBuffer; section <= AEMModelSection_Textures; ++section)
+    {
+      if (file_section_sizes[section] == 0)
+      {
+        continue;
+      }
+
+      const uint64_t section_begin = section_offsets[section];
+      const uint64_t section_end = section_begin + file_section_sizes[section];
+      load_time_data_begin = section_begin < load_time_data_begin ? section_begin : load_time_data_begin;
+      load_time_data_end = section_end > load_time_data_end ? section_end : load_time_data_end;
+    }
+
+    if (load_time_data_end > 0)
+    {
+      model->load_time_data = data + load_time_data_begin;
+      model->load_time_data_size = load_time_data_end - load_time_data_begin;
+    }
+    else
+    {
+      model->load_time_data = data + header_size;
+      model->load_time_data_size = 0;
+    }
+  }
+
+  // Only the resident levels are copied out, the pages of the skipped levels are never touched
+  if (model->skipped_texture_level_count > 0 && model->image_buffer)
+  {
+    if (!compact_image_buffer(model, model->image_buffer))
+    {
+      free_memory(&model->allocator, model->owned_meshes);
+      free_memory(&model->allocator, model->owned_joints);
+      free_memory(&model->allocator, model->joint_order);
+      return AEMModelResult_OutOfMemory;
+    }
+  }
+
+  return AEMModelResult_Success;
+}
 
 enum AEMModelResult aem_load_model(const char* filename, struct AEMModel** model)
 {
-  *model = malloc(sizeof(struct AEMModel));
+  return aem_load_model_with_options(filename, NULL, model);
+}
+
+enum AEMModelResult
+aem_load_model_with_options(const char* filename, const struct AEMModelLoadOptions* options, struct AEMModel** model)
+{
+  FILE* fp = fopen(filename, "rb");
+  if (!fp)
+  {
+    *model = NULL;
+    return AEMModelResult_FileNotFound;
+  }
+
+  const struct AEMReader reader = { fp, read_file, skip_file };
+  const enum AEMModelResult result = aem_load_model_from_reader(&reader, options, model);
+
+  fclose(fp);
+
+  return result;
+}
+
+enum AEMModelResult
+aem_load_model_mapped(const char* filename, const struct AEMModelLoadOptions* options, struct AEMModel** model)
+{
+  *model = allocate_model();
   if (!*model)
   {
     return AEMModelResult_OutOfMemory;
   }
 
-  (*model)->fp = fopen(filename, "rb");
-  if (!(*model)->fp)
+  struct FileMapping* mapping = &(*model)->mapping;
+  if (!map_file(filename, mapping))
   {
+    free_memory(&(*model)->allocator, *model);
+    *model = NULL;
     return AEMModelResult_FileNotFound;
   }
 
-  // Check ID and version number
+  // Misaligned files are read out of the mapping instead, which leaves the model with its own copy
+  const struct AEMModelLoadOptions resolved_options = resolve_load_options(options);
+  const bool is_aligned = are_sections_aligned(mapping->data, mapping->size);
+  enum AEMModelResult result;
+  if (is_aligned)
   {
-    uint8_t id[4];
-    fread(id, sizeof(id), 1, (*model)->fp);
-    if (id[0] != 'A' || id[1] != 'E' || id[2] != 'M')
-    {
-      fclose((*model)->fp);
-      return AEMModelResult_InvalidFileType;
-    }
+    result = load_model_in_place(mapping->data, mapping->size, &resolved_options, *model);
+  }
+  else
+  {
+    struct MemoryReader memory_reader = { mapping->data, (size_t)mapping->size, 0 };
+    const struct AEMReader reader = { &memory_reader, read_memory, skip_memory };
+    result = load_model_from_reader(&reader, &resolved_options, NULL, *model);
+  }
 
-    if (id[3] != 1)
-    {
-      fclose((*model)->fp);
-      return AEMModelResult_InvalidVersion;
-    }
+  if (result != AEMModelResult_Success || !is_aligned)
+  {
+    unmap_file(mapping);
+  }
+
+  if (result != AEMModelResult_Success)
+  {
+    free_memory(&(*model)->allocator, *model);
+    *model = NULL;
+    return result;
+  }
+
+  if (is_aligned)
+  {
+    (*model)->storage = ModelStorage_Mapped;
+  }
+
+  return AEMModelResult_Success;
+}
+
+enum AEMModelResult aem_load_model_from_memory(const void* data,
+                                               size_t size,
+                                               bool borrow,
+                                               const struct AEMModelLoadOptions* options,
+                                               struct AEMModel** model)
+{
+  // Misaligned data is copied even if it was meant to be borrowed
+  if (!borrow || !are_sections_aligned(data, size))
+  {
+    struct MemoryReader memory_reader = { data, size, 0 };
+    const struct AEMReader reader = { &memory_reader, read_memory, skip_memory };
+    return aem_load_model_from_reader(&reader, options, model);
+  }
+
+  *model = allocate_model();
+  if (!*model)
+  {
+    return AEMModelResult_OutOfMemory;
   }
 
-  fread(&(*model)->header, sizeof(struct Header), 1, (*model)->fp); // Header
+  // The model never writes to borrowed data, the cast only exists because the getters hand out mutable pointers
+  const struct AEMModelLoadOptions resolved_options = resolve_load_options(options);
+  const enum AEMModelResult result = load_model_in_place((uint8_t*)data, size, &resolved_options, *model);
+  if (result != AEMModelResult_Success)
+  {
+    free_memory(&(*model)->allocator, *model);
+    *model = NULL;
+  }
 
-  const uint32_t vertex_buffer_size = (*model)->header.vertex_count * AEM_VERTEX_SIZE;
-  const uint32_t index_buffer_size = (*model)->header.index_count * AEM_INDEX_SIZE;
-  const uint64_t image_buffer_size = (*model)->header.image_buffer_size;
-  const uint32_t textures_size = (*model)->header.texture_count * sizeof(struct AEMTexture);
-  const uint32_t meshes_size = (*model)->header.mesh_count * sizeof(struct AEMMesh);
-  const uint32_t materials_size = (*model)->header.material_count * sizeof(struct AEMMaterial);
-  const uint32_t joints_size = (*model)->header.joint_count * sizeof(struct AEMJoint);
-  const uint32_t animations_size = (*model)->header.animation_count * sizeof(struct Animation);
-  const uint32_t tracks_size = (*model)->header.track_count * sizeof(struct Track);
-  const uint32_t keyframes_size = (*model)->header.keyframe_count * sizeof(struct Keyframe);
+  return result;
+}
 
-  const uint64_t load_time_data_size = vertex_buffer_size + index_buffer_size + image_buffer_size + textures_size;
-  (*model)->load_time_data = malloc(load_time_data_size);
-  if (!(*model)->load_time_data)
+enum AEMModelResult aem_load_model_from_reader(const struct AEMReader* reader,
+                                               const struct AEMModelLoadOptions* options,
+                                               struct AEMModel** model)
+{
+  *model = allocate_model();
+  if (!*model)
   {
-    fclose((*model)->fp);
     return AEMModelResult_OutOfMemory;
   }
 
-  fread((*model)->load_time_data, load_time_data_size, 1, (*model)->fp);
+  const struct AEMModelLoadOptions resolved_options = resolve_load_options(options);
+  const enum AEMModelResult result = load_model_from_reader(reader, &resolved_options, NULL, *model);
+  if (result != AEMModelResult_Success)
+  {
+    free_memory(&(*model)->allocator, *model);
+    *model = NULL;
+  }
+
+  return result;
+}
+
+struct AEMModelLoad
+{
+  FILE* fp;
+  struct AEMModelLoadOptions options;
+  AEMModelLoadCallback callback;
+  void* user_data;
+
+  struct AEMModel* model;
+  struct Thread thread;
+  struct AEMAllocator allocator;
+
+  // Shared between the worker thread and the thread that polls the load, guarded by the mutex
+  struct Mutex mutex;
+  enum AEMModelLoadState state;
+  enum AEMModelResult result;
+  struct AEMModelLoadProgress progress;
+  bool header_loaded, cancelled;
+};
+
+static void publish_header(struct AEMModelLoad* load)
+{
+  if (load->header_loaded)
+  {
+    return;
+  }
+
+  uint64_t section_sizes[AEMModelSection_Count];
+  calculate_section_sizes(&load->model->header, load->model->version, section_sizes);
+  load->progress.total_size = sum_section_sizes(section_sizes, 0, AEMModelSection_Count - 1);
+  load->header_loaded = true;
+}
+
+static bool on_async_chunk_loaded(void* user_data,
+                                  enum AEMModelSection section,
+                                  uint64_t loaded_size,
+                                  uint64_t section_size)
+{
+  struct AEMModelLoad* load = (struct AEMModelLoad*)user_data;
+
+  // Chunks are never larger than the load chunk size, so the size of this one can be recovered
+  const uint64_t chunk_size = (loaded_size - 1) % LOAD_CHUNK_SIZE + 1;
+
+  lock_mutex(&load->mutex);
+  publish_header(load);
+  load->progress.loaded_size += chunk_size;
+  const bool cancelled = load->cancelled;
+  unlock_mutex(&load->mutex);
+
+  if (load->callback)
+  {
+    load->callback(load->user_data, section, loaded_size, section_size);
+  }
+
+  return !cancelled;
+}
+
+static void on_async_section_loaded(void* user_data, enum AEMModelSection section)
+{
+  struct AEMModelLoad* load = (struct AEMModelLoad*)user_data;
+
+  lock_mutex(&load->mutex);
+  publish_header(load);
+  load->progress.loaded_sections |= 1 << section;
+  unlock_mutex(&load->mutex);
+}
+
+static void load_model_async(void* argument)
+{
+  struct AEMModelLoad* load = (struct AEMModelLoad*)argument;
+
+  const struct AEMReader reader = { load->fp, read_file, skip_file };
+  const struct LoadObserver observer = { load, on_async_chunk_loaded, on_async_section_loaded };
+  const enum AEMModelResult result = load_model_from_reader(&reader, &load->options, &observer, load->model);
+
+  fclose(load->fp);
+
+  lock_mutex(&load->mutex);
+  load->result = result;
+  load->state = result == AEMModelResult_Success ? AEMModelLoadState_Complete : AEMModelLoadState_Failed;
+  unlock_mutex(&load->mutex);
+}
 
-  const uint32_t run_time_data_size =
-    meshes_size + materials_size + joints_size + animations_size + tracks_size + keyframes_size;
-  (*model)->run_time_data = malloc(run_time_data_size);
-  if (!(*model)->run_time_data)
+enum AEMModelResult aem_begin_loading_model(const char* filename,
+                                            const struct AEMModelLoadOptions* options,
+                                            AEMModelLoadCallback callback,
+                                            void* user_data,
+                                            struct AEMModelLoad** load)
+{
+  const struct AEMAllocator* allocator = get_current_allocator();
+  *load = allocate_memory(allocator, sizeof(struct AEMModelLoad));
+  if (!*load)
   {
-    fclose((*model)->fp);
     return AEMModelResult_OutOfMemory;
   }
 
-  fread((*model)->run_time_data, run_time_data_size, 1, (*model)->fp);
+  memset(*load, 0, sizeof(struct AEMModelLoad));
+  (*load)->allocator = *allocator;
 
-  // Load-time data
+  (*load)->model = allocate_model();
+  if (!(*load)->model)
   {
-    (*model)->vertex_buffer = (struct Vertex*)(*model)->load_time_data;
-    (*model)->index_buffer = (uint32_t*)((uint8_t*)(*model)->vertex_buffer + vertex_buffer_size);
-    (*model)->image_buffer = (uint8_t*)(*model)->index_buffer + index_buffer_size;
-    (*model)->textures = (struct AEMTexture*)((uint8_t*)(*model)->image_buffer + image_buffer_size);
+    free_memory(allocator, *load);
+    *load = NULL;
+    return AEMModelResult_OutOfMemory;
   }
 
-  // Run-time data
+  // Open the file right away so that a missing file is reported immediately
+  (*load)->fp = fopen(filename, "rb");
+  if (!(*load)->fp)
   {
-    (*model)->meshes = (struct AEMMesh*)((*model)->run_time_data);
-    (*model)->materials = (struct AEMMaterial*)((uint8_t*)(*model)->meshes + meshes_size);
-    (*model)->joints = (struct AEMJoint*)((uint8_t*)(*model)->materials + materials_size);
-    (*model)->animations = (struct Animation*)((uint8_t*)(*model)->joints + joints_size);
-    (*model)->tracks = (struct Track*)((uint8_t*)(*model)->animations + animations_size);
-    (*model)->keyframes = (struct Keyframe*)((uint8_t*)(*model)->tracks + tracks_size);
+    free_memory(allocator, (*load)->model);
+    free_memory(allocator, *load);
+    *load = NULL;
+    return AEMModelResult_FileNotFound;
   }
 
-  fclose((*model)->fp);
+  (*load)->options = resolve_load_options(options);
+  (*load)->callback = callback;
+  (*load)->user_data = user_data;
+  (*load)->state = AEMModelLoadState_Loading;
+  init_mutex(&(*load)->mutex);
+
+  if (!create_thread(&(*load)->thread, load_model_async, *load))
+  {
+    fclose((*load)->fp);
+    destroy_mutex(&(*load)->mutex);
+    free_memory(allocator, (*load)->model);
+    free_memory(allocator, *load);
+    *load = NULL;
+    return AEMModelResult_OutOfMemory;
+  }
 
   return AEMModelResult_Success;
 }
 
+enum AEMModelLoadState aem_poll_loading_model(struct AEMModelLoad* load, struct AEMModelLoadProgress* progress)
+{
+  lock_mutex(&load->mutex);
+  const enum AEMModelLoadState state = load->state;
+  if (progress)
+  {
+    *progress = load->progress;
+  }
+  unlock_mutex(&load->mutex);
+
+  return state;
+}
+
+const struct AEMModel* aem_get_loading_model(struct AEMModelLoad* load)
+{
+  lock_mutex(&load->mutex);
+  const bool header_loaded = load->header_loaded && load->state != AEMModelLoadState_Failed;
+  unlock_mutex(&load->mutex);
+
+  return header_loaded ? load->model : NULL;
+}
+
+void aem_cancel_loading_model(struct AEMModelLoad* load)
+{
+  lock_mutex(&load->mutex);
+  load->cancelled = true;
+  unlock_mutex(&load->mutex);
+}
+
+enum AEMModelResult aem_end_loading_model(struct AEMModelLoad* load, struct AEMModel** model)
+{
+  join_thread(&load->thread);
+  destroy_mutex(&load->mutex);
+
+  const enum AEMModelResult result = load->result;
+  if (result == AEMModelResult_Success)
+  {
+    *model = load->model;
+  }
+  else
+  {
+    free_memory(&load->model->allocator, load->model);
+    *model = NULL;
+  }
+
+  free_memory(&load->allocator, load);
+
+  return result;
+}
+
 void aem_finish_loading_model(const struct AEMModel* model)
 {
-  free(model->load_time_data);
+  free_memory(&model->allocator, model->owned_image_buffer);
+
+  if (model->storage == ModelStorage_Owned)
+  {
+    free_memory(&model->allocator, model->load_time_data);
+  }
+  else if (model->storage == ModelStorage_Mapped)
+  {
+    // Hand the pages of the load-time data back to the OS, the run-time data stays mapped
+    const uint64_t offset = (uint8_t*)model->load_time_data - model->mapping.data;
+    release_file_mapping_range(&model->mapping, offset, model->load_time_data_size);
+  }
 }
 
 void aem_free_model(struct AEMModel* model)
 {
-  free(model->run_time_data);
-  free(model);
+  free_memory(&model->allocator, model->owned_meshes);
+  free_memory(&model->allocator, model->owned_joints);
+  free_memory(&model->allocator, model->joint_order);
+
+  if (model->storage == ModelStorage_Owned)
+  {
+    free_memory(&model->allocator, model->run_time_data);
+  }
+  else if (model->storage == ModelStorage_Mapped)
+  {
+    unmap_file(&model->mapping);
+  }
+
+  free_memory(&model->allocator, model);
 }
 
 void aem_print_model_info(struct AEMModel* model)
@@ -107,12 +1533,23 @@ void aem_print_model_info(struct AEMModel* model)
   const struct Header* header = &model->header;
 
   printf("Vertex count: %u\n", header->vertex_count);
+  printf("Vertex format: 0x%x\n", header->vertex_format);
   printf("Index count: %u\n", header->index_count);
+  printf("Index buffer size: %llu bytes\n", header->index_buffer_size);
   printf("Image buffer size: %llu bytes\n", header->image_buffer_size);
   printf("Texture count: %u\n", header->texture_count);
   printf("Mesh count: %u\n", header->mesh_count);
+  printf("Mesh LOD count: %u\n", model->mesh_lod_offsets ? model->mesh_lod_offsets[header->mesh_count] : 0);
+  printf("Meshlet count: %u\n", model->meshlet_offsets ? model->meshlet_offsets[header->mesh_count] : 0);
+  if (model->bounds)
+  {
+    const struct AEMBounds* bounds = model->bounds;
+    printf("Bounds: [ %f, %f, %f ] - [ %f, %f, %f ], radius %f\n", bounds->min[0], bounds->min[1], bounds->min[2],
+           bounds->max[0], bounds->max[1], bounds->max[2], bounds->radius);
+  }
   printf("Material count: %u\n", header->material_count);
   printf("Joint count: %u\n", header->joint_count);
+  printf("Joint names size: %llu bytes\n", header->joint_names_size);
   printf("Animation count: %u\n", header->animation_count);
   printf("Track count: %u\n", header->track_count);
   printf("Keyframe count: %u\n", header->keyframe_count);
@@ -128,6 +1565,16 @@ uint32_t aem_get_model_vertex_count(const struct AEMModel* model)
   return model->header.vertex_count;
 }
 
+uint32_t aem_get_model_vertex_format(const struct AEMModel* model)
+{
+  return model->header.vertex_format;
+}
+
+void* aem_get_model_position_buffer(const struct AEMModel* model)
+{
+  return model->position_buffer;
+}
+
 void* aem_get_model_index_buffer(const struct AEMModel* model)
 {
   return model->index_buffer;
@@ -138,6 +1585,16 @@ uint32_t aem_get_model_index_count(const struct AEMModel* model)
   return model->header.index_count;
 }
 
+uint64_t aem_get_model_index_buffer_size(const struct AEMModel* model)
+{
+  return model->header.index_buffer_size;
+}
+
+uint32_t aem_get_index_size(enum AEMIndexType index_type)
+{
+  return index_type == AEMIndexType_UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
 void* aem_get_model_image_buffer(const struct AEMModel* model)
 {
   return model->image_buffer;
@@ -148,6 +1605,40 @@ uint64_t aem_get_model_image_buffer_size(const struct AEMModel* model)
   return model->header.image_buffer_size;
 }
 
+uint64_t aem_get_model_image_buffer_file_offset(const struct AEMModel* model)
+{
+  return model->image_buffer_file_offset;
+}
+
+const void*
+aem_get_model_texture_data(const struct AEMModel* model, const struct AEMTexture* texture, uint32_t* first_level)
+{
+  *first_level = get_first_resident_texture_level(model, texture);
+
+  if (!model->owned_image_buffer)
+  {
+    uint64_t offset, size;
+    aem_get_model_texture_level_range(texture, *first_level, 0, &offset, &size);
+    return model->image_buffer + offset;
+  }
+
+  // The compacted image buffer holds the resident levels of all textures back to back in texture order
+  uint64_t compacted_offset = 0;
+  for (const struct AEMTexture* previous_texture = model->textures; previous_texture != texture; ++previous_texture)
+  {
+    const uint32_t previous_first_level = get_first_resident_texture_level(model, previous_texture);
+    const uint32_t previous_level_count =
+      aem_get_model_texture_level_count(previous_texture->width, previous_texture->height);
+
+    uint64_t offset, size;
+    aem_get_model_texture_level_range(previous_texture, previous_first_level,
+                                      previous_level_count - previous_first_level, &offset, &size);
+    compacted_offset += size;
+  }
+
+  return model->image_buffer + compacted_offset;
+}
+
 uint32_t aem_get_model_mesh_count(const struct AEMModel* model)
 {
   return model->header.mesh_count;
@@ -158,6 +1649,110 @@ const struct AEMMesh* aem_get_model_mesh(const struct AEMModel* model, uint32_t
   return &model->meshes[mesh_index];
 }
 
+const struct AEMBounds* aem_get_model_bounds(const struct AEMModel* model)
+{
+  return model->bounds;
+}
+
+const struct AEMBounds* aem_get_model_mesh_bounds(const struct AEMModel* model, uint32_t mesh_index)
+{
+  if (!model->bounds)
+  {
+    return NULL;
+  }
+
+  return &model->bounds[1 + mesh_index];
+}
+
+uint32_t aem_get_model_mesh_lod_count(const struct AEMModel* model, uint32_t mesh_index)
+{
+  if (!model->mesh_lod_offsets)
+  {
+    return 1;
+  }
+
+  return 1 + model->mesh_lod_offsets[mesh_index + 1] - model->mesh_lod_offsets[mesh_index];
+}
+
+void aem_get_model_mesh_lod(const struct AEMModel* model,
+                            uint32_t mesh_index,
+                            uint32_t lod_index,
+                            struct AEMMeshLOD* lod)
+{
+  if (lod_index == 0)
+  {
+    const struct AEMMesh* mesh = &model->meshes[mesh_index];
+    lod->first_index = mesh->first_index;
+    lod->index_count = mesh->index_count;
+    lod->error = 0.0f;
+    return;
+  }
+
+  *lod = model->mesh_lods[model->mesh_lod_offsets[mesh_index] + lod_index - 1];
+}
+
+float aem_get_mesh_lod_screen_space_error(const struct AEMMeshLOD* lod, float distance, float projection_scale)
+{
+  // Errors are not allowed to vanish right in front of the camera
+  return lod->error / (distance > 1e-6f ? distance : 1e-6f) * projection_scale;
+}
+
+uint32_t aem_select_model_mesh_lod(const struct AEMModel* model,
+                                   uint32_t mesh_index,
+                                   float distance,
+                                   float projection_scale,
+                                   float max_screen_space_error)
+{
+  // Errors grow from LOD to LOD, so the first one that is too coarse ends the search
+  const uint32_t lod_count = aem_get_model_mesh_lod_count(model, mesh_index);
+  uint32_t lod_index = 0;
+  while (lod_index + 1 < lod_count)
+  {
+    struct AEMMeshLOD lod;
+    aem_get_model_mesh_lod(model, mesh_index, lod_index + 1, &lod);
+    if (aem_get_mesh_lod_screen_space_error(&lod, distance, projection_scale) > max_screen_space_error)
+    {
+      break;
+    }
+
+    ++lod_index;
+  }
+
+  return lod_index;
+}
+
+uint32_t aem_get_model_mesh_meshlet_count(const struct AEMModel* model, uint32_t mesh_index)
+{
+  if (!model->meshlet_offsets)
+  {
+    return 0;
+  }
+
+  return model->meshlet_offsets[mesh_index + 1] - model->meshlet_offsets[mesh_index];
+}
+
+const struct AEMMeshlet* aem_get_model_mesh_meshlets(const struct AEMModel* model, uint32_t mesh_index)
+{
+  if (!model->meshlet_offsets)
+  {
+    return NULL;
+  }
+
+  return &model->meshlets[model->meshlet_offsets[mesh_index]];
+}
+
+bool aem_is_meshlet_back_facing(const struct AEMMeshlet* meshlet, const float* camera_position)
+{
+  const float direction[3] = { meshlet->cone_apex[0] - camera_position[0], meshlet->cone_apex[1] - camera_position[1],
+                               meshlet->cone_apex[2] - camera_position[2] };
+  const float dot =
+    direction[0] * meshlet->cone_axis[0] + direction[1] * meshlet->cone_axis[1] + direction[2] * meshlet->cone_axis[2];
+  const float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+
+  // Meshlets whose cone can't cull anything have a zero axis and a cutoff of 1, which never passes
+  return dot >= meshlet->cone_cutoff * length;
+}
+
 const struct AEMMaterial* aem_get_model_material(const struct AEMModel* model, uint32_t material_index)
 {
   if (material_index < 0 || material_index >= model->header.material_count)
@@ -179,9 +1774,83 @@ uint32_t aem_get_model_joint_count(const struct AEMModel* model)
   return model->header.joint_count;
 }
 
-struct AEMJoint* aem_get_model_joints(const struct AEMModel* model)
+const int32_t* aem_get_model_joint_parent_indices(const struct AEMModel* model)
+{
+  return model->joint_parent_indices;
+}
+
+const float* aem_get_model_joint_inverse_bind_matrices(const struct AEMModel* model)
+{
+  return model->joint_inverse_bind_matrices;
+}
+
+void aem_get_model_joint_inverse_bind_matrix(const struct AEMModel* model, uint32_t joint_index, float matrix[16])
+{
+  const float* inverse_bind_matrix = &model->joint_inverse_bind_matrices[joint_index * 12];
+  for (uint32_t column = 0; column < 4; ++column)
+  {
+    for (uint32_t row = 0; row < 3; ++row)
+    {
+      matrix[column * 4 + row] = inverse_bind_matrix[row * 4 + column];
+    }
+
+    matrix[column * 4 + 3] = column == 3 ? 1.0f : 0.0f;
+  }
+}
+
+const char* aem_get_model_joint_name(const struct AEMModel* model, uint32_t joint_index)
+{
+  const struct JointNameTable* joint_name_table = model->joint_name_table;
+  if (!joint_name_table)
+  {
+    return NULL;
+  }
+
+  const uint32_t joint_count = model->header.joint_count;
+  return get_joint_name_strings(joint_name_table, joint_count) +
+         get_joint_name_offsets(joint_name_table)[joint_index];
+}
+
+int32_t aem_find_model_joint(const struct AEMModel* model, const char* name)
+{
+  const struct JointNameTable* joint_name_table = model->joint_name_table;
+  if (!joint_name_table)
+  {
+    return -1;
+  }
+
+  // Probe from the bucket of the hash until the joint or an empty bucket is found
+  const uint32_t* buckets = get_joint_name_buckets(joint_name_table, model->header.joint_count);
+  uint32_t bucket_index = aem_hash_joint_name(name) % joint_name_table->bucket_count;
+  for (uint32_t probe_count = 0; probe_count < joint_name_table->bucket_count; ++probe_count)
+  {
+    const uint32_t bucket = buckets[bucket_index];
+    if (bucket == 0)
+    {
+      break;
+    }
+
+    if (strcmp(aem_get_model_joint_name(model, bucket - 1), name) == 0)
+    {
+      return (int32_t)(bucket - 1);
+    }
+
+    bucket_index = (bucket_index + 1) % joint_name_table->bucket_count;
+  }
+
+  return -1;
+}
+
+uint32_t aem_hash_joint_name(const char* name)
 {
-  return model->joints;
+  // 32-bit FNV-1a
+  uint32_t hash = 2166136261u;
+  for (const uint8_t* c = (const uint8_t*)name; *c; ++c)
+  {
+    hash = (hash ^ *c) * 16777619u;
+  }
+
+  return hash;
 }
 
 uint32_t aem_get_model_animation_count(const struct AEMModel* model)
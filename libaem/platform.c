@@ -0,0 +1,243 @@
+#include "platform.h"
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+static uint64_t get_page_size()
+{
+#ifdef _WIN32
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  return system_info.dwPageSize;
+#else
+  return (uint64_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+bool map_file(const char* filename, struct FileMapping* mapping)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  // Copy-on-write so that callers can still modify the data they get handed without touching the file
+  HANDLE file_mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  CloseHandle(file); // The mapping object keeps the file open
+  if (!file_mapping)
+  {
+    return false;
+  }
+
+  void* data = MapViewOfFile(file_mapping, FILE_MAP_COPY, 0, 0, 0);
+  if (!data)
+  {
+    CloseHandle(file_mapping);
+    return false;
+  }
+
+  mapping->data = data;
+  mapping->size = (uint64_t)file_size.QuadPart;
+  mapping->handle = file_mapping;
+#else
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  // Copy-on-write so that callers can still modify the data they get handed without touching the file
+  void* data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps the file open
+  if (data == MAP_FAILED)
+  {
+    return false;
+  }
+
+  // The loader walks the file front to back
+  madvise(data, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+
+  mapping->data = data;
+  mapping->size = (uint64_t)file_stat.st_size;
+  mapping->handle = NULL;
+#endif
+
+  return true;
+}
+
+void unmap_file(const struct FileMapping* mapping)
+{
+#ifdef _WIN32
+  UnmapViewOfFile(mapping->data);
+  CloseHandle(mapping->handle);
+#else
+  munmap(mapping->data, (size_t)mapping->size);
+#endif
+}
+
+void release_file_mapping_range(const struct FileMapping* mapping, uint64_t offset, uint64_t size)
+{
+  // Only whole pages inside of the range can be released, partial pages at either end are kept
+  const uint64_t page_size = get_page_size();
+  const uint64_t begin = (uint64_t)(uintptr_t)mapping->data + offset;
+  const uint64_t first_page = (begin + page_size - 1) & ~(page_size - 1);
+  const uint64_t end_page = (begin + size) & ~(page_size - 1);
+  if (end_page <= first_page)
+  {
+    return;
+  }
+
+#ifdef _WIN32
+  // Unlocking pages that are not locked removes them from the working set of the process
+  VirtualUnlock((void*)(uintptr_t)first_page, (SIZE_T)(end_page - first_page));
+#else
+  madvise((void*)(uintptr_t)first_page, (size_t)(end_page - first_page), MADV_DONTNEED);
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI run_thread(LPVOID parameter)
+{
+  struct Thread* thread = (struct Thread*)parameter;
+  thread->function(thread->argument);
+  return 0;
+}
+#else
+static void* run_thread(void* parameter)
+{
+  struct Thread* thread = (struct Thread*)parameter;
+  thread->function(thread->argument);
+  return NULL;
+}
+#endif
+
+bool create_thread(struct Thread* thread, void (*function)(void* argument), void* argument)
+{
+  thread->function = function;
+  thread->argument = argument;
+
+#ifdef _WIN32
+  thread->handle = CreateThread(NULL, 0, run_thread, thread, 0, NULL);
+  return thread->handle != NULL;
+#else
+  return pthread_create(&thread->handle, NULL, run_thread, thread) == 0;
+#endif
+}
+
+void join_thread(struct Thread* thread)
+{
+#ifdef _WIN32
+  WaitForSingleObject(thread->handle, INFINITE);
+  CloseHandle(thread->handle);
+#else
+  pthread_join(thread->handle, NULL);
+#endif
+}
+
+uint32_t get_processor_count()
+{
+#ifdef _WIN32
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  return system_info.dwNumberOfProcessors;
+#else
+  const long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+  return processor_count > 0 ? (uint32_t)processor_count : 1;
+#endif
+}
+
+void init_mutex(struct Mutex* mutex)
+{
+#ifdef _WIN32
+  InitializeSRWLock((PSRWLOCK)&mutex->lock);
+#else
+  pthread_mutex_init(&mutex->lock, NULL);
+#endif
+}
+
+void destroy_mutex(struct Mutex* mutex)
+{
+#ifdef _WIN32
+  (void)mutex; // SRW locks don't need to be destroyed
+#else
+  pthread_mutex_destroy(&mutex->lock);
+#endif
+}
+
+void lock_mutex(struct Mutex* mutex)
+{
+#ifdef _WIN32
+  AcquireSRWLockExclusive((PSRWLOCK)&mutex->lock);
+#else
+  pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+void unlock_mutex(struct Mutex* mutex)
+{
+#ifdef _WIN32
+  ReleaseSRWLockExclusive((PSRWLOCK)&mutex->lock);
+#else
+  pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+void init_condition_variable(struct ConditionVariable* condition_variable)
+{
+#ifdef _WIN32
+  InitializeConditionVariable((PCONDITION_VARIABLE)&condition_variable->condition);
+#else
+  pthread_cond_init(&condition_variable->condition, NULL);
+#endif
+}
+
+void destroy_condition_variable(struct ConditionVariable* condition_variable)
+{
+#ifdef _WIN32
+  (void)condition_variable; // Condition variables don't need to be destroyed
+#else
+  pthread_cond_destroy(&condition_variable->condition);
+#endif
+}
+
+void wait_condition_variable(struct ConditionVariable* condition_variable, struct Mutex* mutex)
+{
+#ifdef _WIN32
+  SleepConditionVariableSRW((PCONDITION_VARIABLE)&condition_variable->condition, (PSRWLOCK)&mutex->lock, INFINITE, 0);
+#else
+  pthread_cond_wait(&condition_variable->condition, &mutex->lock);
+#endif
+}
+
+void wake_condition_variable(struct ConditionVariable* condition_variable)
+{
+#ifdef _WIN32
+  WakeAllConditionVariable((PCONDITION_VARIABLE)&condition_variable->condition);
+#else
+  pthread_cond_broadcast(&condition_variable->condition);
+#endif
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+  #include <pthread.h>
+#endif
+
+// A read-only view of an entire file that is mapped copy-on-write into the address space
+struct FileMapping
+{
+  uint8_t* data;
+  uint64_t size;
+
+  void* handle; // Platform-specific handle that is needed to unmap the file again
+};
+
+bool map_file(const char* filename, struct FileMapping* mapping);
+void unmap_file(const struct FileMapping* mapping);
+
+// Drops the physical pages backing a range of the mapping, they are paged in from the file again if touched afterwards
+void release_file_mapping_range(const struct FileMapping* mapping, uint64_t offset, uint64_t size);
+
+struct Thread
+{
+#ifdef _WIN32
+  void* handle;
+#else
+  pthread_t handle;
+#endif
+
+  void (*function)(void* argument);
+  void* argument;
+};
+
+// The thread struct has to stay alive until the thread has been joined
+bool create_thread(struct Thread* thread, void (*function)(void* argument), void* argument);
+void join_thread(struct Thread* thread);
+
+uint32_t get_processor_count();
+
+struct Mutex
+{
+#ifdef _WIN32
+  void* lock; // Storage for an SRWLOCK, which is the size of a pointer
+#else
+  pthread_mutex_t lock;
+#endif
+};
+
+void init_mutex(struct Mutex* mutex);
+void destroy_mutex(struct Mutex* mutex);
+void lock_mutex(struct Mutex* mutex);
+void unlock_mutex(struct Mutex* mutex);
+
+struct ConditionVariable
+{
+#ifdef _WIN32
+  void* condition; // Storage for a CONDITION_VARIABLE, which is the size of a pointer
+#else
+  pthread_cond_t condition;
+#endif
+};
+
+void init_condition_variable(struct ConditionVariable* condition_variable);
+void destroy_condition_variable(struct ConditionVariable* condition_variable);
+void wait_condition_variable(struct ConditionVariable* condition_variable, struct Mutex* mutex); // Mutex is locked
+void wake_condition_variable(struct ConditionVariable* condition_variable); // Wakes all waiting threads
@@ -0,0 +1,136 @@
+#include "pose_cache.h"
+#include "memory.h"
+
+#include <string.h>
+
+enum AEMAnimationMixerResult
+aem_create_pose_cache(uint32_t entry_count, uint32_t joint_count, float time_step, struct AEMPoseCache** pose_cache)
+{
+  // The cache, its entries and all of their poses live in a single allocation
+  const uint32_t group_count = (joint_count + LANE_COUNT - 1) / LANE_COUNT;
+  const size_t entries_offset = align_up(sizeof(struct AEMPoseCache), sizeof(void*));
+  const size_t poses_offset = entries_offset + sizeof(struct PoseCacheEntry) * entry_count;
+  const size_t poses_size = sizeof(struct PoseLanes) * group_count * entry_count;
+
+  const struct AEMAllocator* allocator = get_current_allocator();
+  uint8_t* memory = allocate_memory(allocator, poses_offset + poses_size);
+  if (!memory)
+  {
+    *pose_cache = NULL;
+    return AEMAnimationMixerResult_OutOfMemory;
+  }
+
+  *pose_cache = (struct AEMPoseCache*)memory;
+  (*pose_cache)->allocator = *allocator;
+  (*pose_cache)->entries = (struct PoseCacheEntry*)(memory + entries_offset);
+  (*pose_cache)->poses = (struct PoseLanes*)(memory + poses_offset);
+  memset((*pose_cache)->entries, 0, sizeof(struct PoseCacheEntry) * entry_count);
+
+  for (uint32_t entry_index = 0; entry_index < entry_count; ++entry_index)
+  {
+    (*pose_cache)->entries[entry_index].groups = &(*pose_cache)->poses[entry_index * group_count];
+  }
+
+  init_mutex(&(*pose_cache)->mutex);
+  (*pose_cache)->entry_count = entry_count;
+  (*pose_cache)->joint_count = joint_count;
+  (*pose_cache)->time_step = time_step;
+  (*pose_cache)->use_count = 0;
+
+  return AEMAnimationMixerResult_Success;
+}
+
+void aem_free_pose_cache(struct AEMPoseCache* pose_cache)
+{
+  destroy_mutex(&pose_cache->mutex);
+  free_memory(&pose_cache->allocator, pose_cache);
+}
+
+void aem_clear_pose_cache(struct AEMPoseCache* pose_cache)
+{
+  lock_mutex(&pose_cache->mutex);
+
+  for (uint32_t entry_index = 0; entry_index < pose_cache->entry_count; ++entry_index)
+  {
+    pose_cache->entries[entry_index].is_valid = false;
+  }
+
+  unlock_mutex(&pose_cache->mutex);
+}
+
+struct PoseCacheEntry* acquire_pose_cache_entry(struct AEMPoseCache* pose_cache,
+                                                const struct AEMModel* model,
+                                                uint32_t animation_index,
+                                                int32_t time_index,
+                                                bool* needs_sampling)
+{
+  *needs_sampling = false;
+
+  lock_mutex(&pose_cache->mutex);
+
+  // A linear search is fine for the few dozen entries that a frame needs, it also finds the entry to evict
+  struct PoseCacheEntry* found_entry = NULL;
+  struct PoseCacheEntry* least_recently_used_entry = NULL;
+  for (uint32_t entry_index = 0; entry_index < pose_cache->entry_count; ++entry_index)
+  {
+    struct PoseCacheEntry* entry = &pose_cache->entries[entry_index];
+    if (entry->is_valid && entry->model == model && entry->animation_index == animation_index &&
+        entry->time_index == time_index)
+    {
+      found_entry = entry;
+      break;
+    }
+
+    if (entry->user_count > 0)
+    {
+      continue;
+    }
+
+    if (!least_recently_used_entry || !entry->is_valid ||
+        (least_recently_used_entry->is_valid && entry->last_use < least_recently_used_entry->last_use))
+    {
+      least_recently_used_entry = entry;
+    }
+  }
+
+  struct PoseCacheEntry* result = NULL;
+  if (found_entry)
+  {
+    // Don't wait for another user to finish sampling the pose
+    if (found_entry->is_sampled)
+    {
+      result = found_entry;
+    }
+  }
+  else if (least_recently_used_entry)
+  {
+    result = least_recently_used_entry;
+    result->model = model;
+    result->animation_index = animation_index;
+    result->time_index = time_index;
+    result->is_valid = true;
+    result->is_sampled = false;
+    *needs_sampling = true;
+  }
+
+  if (result)
+  {
+    result->last_use = ++pose_cache->use_count;
+    ++result->user_count;
+  }
+
+  unlock_mutex(&pose_cache->mutex);
+
+  return result;
+}
+
+void release_pose_cache_entry(struct AEMPoseCache* pose_cache, struct PoseCacheEntry* entry)
+{
+  lock_mutex(&pose_cache->mutex);
+
+  // The only user of a new entry is the one sampling it
+  entry->is_sampled = true;
+  --entry->user_count;
+
+  unlock_mutex(&pose_cache->mutex);
+}
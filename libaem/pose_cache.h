@@ -0,0 +1,49 @@
+#pragma once
+
+#include "allocator.h"
+#include "animation_mixer.h"
+#include "platform.h"
+#include "simd.h"
+
+// Local transforms of a group of joints, one joint per lane
+struct PoseLanes
+{
+  float translation[3][LANE_COUNT];
+  float rotation[4][LANE_COUNT];
+  float scale[3][LANE_COUNT];
+};
+
+// The sampled pose of one animation at one point in time, before any blending between channels
+struct PoseCacheEntry
+{
+  const struct AEMModel* model;
+  uint32_t animation_index;
+  int32_t time_index; // Time in steps of the cache
+
+  struct PoseLanes* groups; // One per group of joints
+  uint64_t last_use;        // For evicting the least recently used entry
+  uint32_t user_count;      // Entries in use can't be evicted
+  bool is_valid, is_sampled;
+};
+
+struct AEMPoseCache
+{
+  struct Mutex mutex;
+  struct PoseCacheEntry* entries;
+  struct PoseLanes* poses; // The groups of all entries
+  uint32_t entry_count;
+  uint32_t joint_count; // Poses of models with more joints don't fit
+  float time_step;
+  uint64_t use_count;
+
+  struct AEMAllocator allocator;
+};
+
+// Returns the entry for a pose and keeps it from being evicted until it is released again, or NULL if the entry is
+// still being sampled by another user or if all entries are in use. A new entry has to be sampled by the caller first.
+struct PoseCacheEntry* acquire_pose_cache_entry(struct AEMPoseCache* pose_cache,
+                                                const struct AEMModel* model,
+                                                uint32_t animation_index,
+                                                int32_t time_index,
+                                                bool* needs_sampling);
+void release_pose_cache_entry(struct AEMPoseCache* pose_cache, struct PoseCacheEntry* entry);
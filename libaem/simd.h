@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cglm/common.h>
+
+#include <math.h>
+
+// A few lanes of floats that are processed together. The instruction set is picked at build time by cglm, which detects
+// AVX, SSE2 and NEON from the compiler flags, without any of them the lanes fall back to plain loops.
+#if defined(CGLM_AVX_FP)
+  #define LANE_COUNT 8
+typedef __m256 Lanes;
+#elif defined(CGLM_SSE2_FP)
+  #define LANE_COUNT 4
+typedef __m128 Lanes;
+#elif defined(CGLM_NEON_FP)
+  #define LANE_COUNT 4
+typedef float32x4_t Lanes;
+#else
+  #define LANE_COUNT 4
+typedef struct
+{
+  float lanes[LANE_COUNT];
+} Lanes;
+#endif
+
+static inline Lanes lanes_load(const float* source)
+{
+#if defined(CGLM_AVX_FP)
+  return _mm256_loadu_ps(source);
+#elif defined(CGLM_SSE2_FP)
+  return _mm_loadu_ps(source);
+#elif defined(CGLM_NEON_FP)
+  return vld1q_f32(source);
+#else
+  Lanes result;
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    result.lanes[lane] = source[lane];
+  }
+  return result;
+#endif
+}
+
+static inline void lanes_store(Lanes a, float* destination)
+{
+#if defined(CGLM_AVX_FP)
+  _mm256_storeu_ps(destination, a);
+#elif defined(CGLM_SSE2_FP)
+  _mm_storeu_ps(destination, a);
+#elif defined(CGLM_NEON_FP)
+  vst1q_f32(destination, a);
+#else
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    destination[lane] = a.lanes[lane];
+  }
+#endif
+}
+
+static inline Lanes lanes_set(float value)
+{
+#if defined(CGLM_AVX_FP)
+  return _mm256_set1_ps(value);
+#elif defined(CGLM_SSE2_FP)
+  return _mm_set1_ps(value);
+#elif defined(CGLM_NEON_FP)
+  return vdupq_n_f32(value);
+#else
+  Lanes result;
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    result.lanes[lane] = value;
+  }
+  return result;
+#endif
+}
+
+static inline Lanes lanes_add(Lanes a, Lanes b)
+{
+#if defined(CGLM_AVX_FP)
+  return _mm256_add_ps(a, b);
+#elif defined(CGLM_SSE2_FP)
+  return _mm_add_ps(a, b);
+#elif defined(CGLM_NEON_FP)
+  return vaddq_f32(a, b);
+#else
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    a.lanes[lane] += b.lanes[lane];
+  }
+  return a;
+#endif
+}
+
+static inline Lanes lanes_sub(Lanes a, Lanes b)
+{
+#if defined(CGLM_AVX_FP)
+  return _mm256_sub_ps(a, b);
+#elif defined(CGLM_SSE2_FP)
+  return _mm_sub_ps(a, b);
+#elif defined(CGLM_NEON_FP)
+  return vsubq_f32(a, b);
+#else
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    a.lanes[lane] -= b.lanes[lane];
+  }
+  return a;
+#endif
+}
+
+static inline Lanes lanes_mul(Lanes a, Lanes b)
+{
+#if defined(CGLM_AVX_FP)
+  return _mm256_mul_ps(a, b);
+#elif defined(CGLM_SSE2_FP)
+  return _mm_mul_ps(a, b);
+#elif defined(CGLM_NEON_FP)
+  return vmulq_f32(a, b);
+#else
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    a.lanes[lane] *= b.lanes[lane];
+  }
+  return a;
+#endif
+}
+
+// Full precision, the reciprocal square root estimates are not accurate enough to normalize rotations with
+static inline Lanes lanes_inverse_sqrt(Lanes a)
+{
+#if defined(CGLM_AVX_FP)
+  return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(a));
+#elif defined(CGLM_SSE2_FP)
+  return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a));
+#elif defined(CGLM_NEON_FP) && defined(__aarch64__)
+  return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(a));
+#elif defined(CGLM_NEON_FP)
+  // 32-bit NEON has no division or square root, refine the estimate until it is accurate to about a float
+  Lanes estimate = vrsqrteq_f32(a);
+  estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a, estimate), estimate));
+  estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a, estimate), estimate));
+  return vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a, estimate), estimate));
+#else
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    a.lanes[lane] = 1.0f / sqrtf(a.lanes[lane]);
+  }
+  return a;
+#endif
+}
+
+// Flips the sign of the lanes in a where the lane in b is negative
+static inline Lanes lanes_flip_sign(Lanes a, Lanes b)
+{
+#if defined(CGLM_AVX_FP)
+  return _mm256_xor_ps(a, _mm256_and_ps(b, _mm256_set1_ps(-0.0f)));
+#elif defined(CGLM_SSE2_FP)
+  return _mm_xor_ps(a, _mm_and_ps(b, _mm_set1_ps(-0.0f)));
+#elif defined(CGLM_NEON_FP)
+  const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(b), vdupq_n_u32(0x80000000u));
+  return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), sign));
+#else
+  for (int lane = 0; lane < LANE_COUNT; ++lane)
+  {
+    a.lanes[lane] = signbit(b.lanes[lane]) ? -a.lanes[lane] : a.lanes[lane];
+  }
+  return a;
+#endif
+}
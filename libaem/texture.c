@@ -29,4 +29,27 @@ void aem_get_model_texture_level_data(const struct AEMTexture* texture,
     const uint32_t block_height = (*level_height + 3) / 4;
     *level_size = block_width * block_height * 16; // 16 bytes per BC5 or 7 block
   }
+}
+
+void aem_get_model_texture_level_range(const struct AEMTexture* texture,
+                                       uint32_t first_level,
+                                       uint32_t level_count,
+                                       uint64_t* offset,
+                                       uint64_t* size)
+{
+  *offset = texture->offset;
+  for (uint32_t level_index = 0; level_index < first_level; ++level_index)
+  {
+    uint32_t level_width, level_height, level_size;
+    aem_get_model_texture_level_data(texture, level_index, &level_width, &level_height, &level_size);
+    *offset += level_size;
+  }
+
+  *size = 0;
+  for (uint32_t level_index = first_level; level_index < first_level + level_count; ++level_index)
+  {
+    uint32_t level_width, level_height, level_size;
+    aem_get_model_texture_level_data(texture, level_index, &level_width, &level_height, &level_size);
+    *size += level_size;
+  }
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "animation_mixer.h"
+#include "memory.h"
+#include "platform.h"
+
+struct AEMAnimationThreadPool
+{
+  struct Thread* threads;
+  uint32_t thread_count;
+
+  // Shared between the dispatching thread and the worker threads, guarded by the mutex
+  struct Mutex mutex;
+  struct ConditionVariable work_available, work_done;
+  AEMAnimationJob job;
+  void* job_data;
+  uint32_t job_count, next_job_index, remaining_job_count;
+  uint32_t dispatch_count; // Lets workers tell a new dispatch from the one they already worked on
+  bool is_shutting_down;
+
+  struct AEMAllocator allocator;
+};
+
+// Runs jobs of the current dispatch until there are none left to claim, the mutex has to be locked
+static void run_jobs(struct AEMAnimationThreadPool* thread_pool)
+{
+  while (thread_pool->next_job_index < thread_pool->job_count)
+  {
+    const uint32_t job_index = thread_pool->next_job_index++;
+
+    unlock_mutex(&thread_pool->mutex);
+    thread_pool->job(thread_pool->job_data, job_index);
+    lock_mutex(&thread_pool->mutex);
+
+    if (--thread_pool->remaining_job_count == 0)
+    {
+      wake_condition_variable(&thread_pool->work_done);
+    }
+  }
+}
+
+static void run_worker(void* argument)
+{
+  struct AEMAnimationThreadPool* thread_pool = (struct AEMAnimationThreadPool*)argument;
+
+  lock_mutex(&thread_pool->mutex);
+
+  uint32_t dispatch_count = thread_pool->dispatch_count;
+  while (true)
+  {
+    while (thread_pool->dispatch_count == dispatch_count && !thread_pool->is_shutting_down)
+    {
+      wait_condition_variable(&thread_pool->work_available, &thread_pool->mutex);
+    }
+
+    if (thread_pool->is_shutting_down)
+    {
+      break;
+    }
+
+    dispatch_count = thread_pool->dispatch_count;
+    run_jobs(thread_pool);
+  }
+
+  unlock_mutex(&thread_pool->mutex);
+}
+
+enum AEMAnimationMixerResult aem_create_animation_thread_pool(uint32_t thread_count,
+                                                              struct AEMAnimationThreadPool** thread_pool)
+{
+  const struct AEMAllocator* allocator = get_current_allocator();
+  *thread_pool = allocate_memory(allocator, sizeof(struct AEMAnimationThreadPool));
+  if (!*thread_pool)
+  {
+    return AEMAnimationMixerResult_OutOfMemory;
+  }
+
+  (*thread_pool)->allocator = *allocator;
+
+  if (thread_count == 0)
+  {
+    thread_count = get_processor_count();
+  }
+
+  // The dispatching thread makes up for the missing thread
+  const uint32_t worker_count = thread_count > 1 ? thread_count - 1 : 0;
+  (*thread_pool)->threads = allocate_memory(allocator, sizeof(struct Thread) * worker_count);
+  if (!(*thread_pool)->threads)
+  {
+    free_memory(allocator, *thread_pool);
+    *thread_pool = NULL;
+    return AEMAnimationMixerResult_OutOfMemory;
+  }
+
+  init_mutex(&(*thread_pool)->mutex);
+  init_condition_variable(&(*thread_pool)->work_available);
+  init_condition_variable(&(*thread_pool)->work_done);
+  (*thread_pool)->job = NULL;
+  (*thread_pool)->job_data = NULL;
+  (*thread_pool)->job_count = (*thread_pool)->next_job_index = (*thread_pool)->remaining_job_count = 0;
+  (*thread_pool)->dispatch_count = 0;
+  (*thread_pool)->is_shutting_down = false;
+
+  // Start as many workers as possible, the pool still works with fewer of them
+  (*thread_pool)->thread_count = 0;
+  for (uint32_t thread_index = 0; thread_index < worker_count; ++thread_index)
+  {
+    if (!create_thread(&(*thread_pool)->threads[thread_index], run_worker, *thread_pool))
+    {
+      break;
+    }
+
+    ++(*thread_pool)->thread_count;
+  }
+
+  return AEMAnimationMixerResult_Success;
+}
+
+void aem_free_animation_thread_pool(struct AEMAnimationThreadPool* thread_pool)
+{
+  lock_mutex(&thread_pool->mutex);
+  thread_pool->is_shutting_down = true;
+  wake_condition_variable(&thread_pool->work_available);
+  unlock_mutex(&thread_pool->mutex);
+
+  for (uint32_t thread_index = 0; thread_index < thread_pool->thread_count; ++thread_index)
+  {
+    join_thread(&thread_pool->threads[thread_index]);
+  }
+
+  destroy_condition_variable(&thread_pool->work_done);
+  destroy_condition_variable(&thread_pool->work_available);
+  destroy_mutex(&thread_pool->mutex);
+
+  free_memory(&thread_pool->allocator, thread_pool->threads);
+  free_memory(&thread_pool->allocator, thread_pool);
+}
+
+void aem_dispatch_animation_jobs(void* thread_pool_, AEMAnimationJob job, void* job_data, uint32_t job_count)
+{
+  struct AEMAnimationThreadPool* thread_pool = (struct AEMAnimationThreadPool*)thread_pool_;
+  if (job_count == 0)
+  {
+    return;
+  }
+
+  lock_mutex(&thread_pool->mutex);
+
+  thread_pool->job = job;
+  thread_pool->job_data = job_data;
+  thread_pool->job_count = thread_pool->remaining_job_count = job_count;
+  thread_pool->next_job_index = 0;
+  ++thread_pool->dispatch_count;
+  wake_condition_variable(&thread_pool->work_available);
+
+  // Help out instead of idling, then wait for the jobs that the workers are still running
+  run_jobs(thread_pool);
+  while (thread_pool->remaining_job_count > 0)
+  {
+    wait_condition_variable(&thread_pool->work_done, &thread_pool->mutex);
+  }
+
+  unlock_mutex(&thread_pool->mutex);
+}
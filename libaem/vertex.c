@@ -0,0 +1,87 @@
+#include "model.h"
+
+static void set_attribute(struct AEMVertexLayout* layout,
+                          enum AEMVertexStream stream,
+                          enum AEMVertexAttribute attribute,
+                          enum AEMVertexAttributeType type,
+                          uint32_t component_count,
+                          bool normalized)
+{
+  static const uint32_t type_sizes[] = { 0, 4, 2, 4, 2, 2, 1, 1 }; // Indexed by AEMVertexAttributeType
+
+  struct AEMVertexAttributeLayout* attribute_layout = &layout->attributes[attribute];
+  attribute_layout->type = type;
+  attribute_layout->component_count = component_count;
+  attribute_layout->stream = stream;
+  attribute_layout->offset = layout->strides[stream];
+  attribute_layout->normalized = normalized;
+
+  layout->strides[stream] += type_sizes[type] * component_count;
+}
+
+void aem_get_vertex_layout(uint32_t vertex_format, struct AEMVertexLayout* layout)
+{
+  layout->format = vertex_format;
+  for (uint32_t stream = 0; stream < AEMVertexStream_Count; ++stream)
+  {
+    layout->strides[stream] = 0;
+  }
+
+  // Split formats move the attributes that are needed by depth-only passes into the position stream
+  const enum AEMVertexStream shading_stream = AEMVertexStream_Vertices;
+  const enum AEMVertexStream position_stream =
+    vertex_format & AEM_VERTEX_FORMAT_SPLIT_STREAMS ? AEMVertexStream_Positions : AEMVertexStream_Vertices;
+
+  for (uint32_t attribute = 0; attribute < AEMVertexAttribute_Count; ++attribute)
+  {
+    layout->attributes[attribute].type = AEMVertexAttributeType_None;
+    layout->attributes[attribute].component_count = layout->attributes[attribute].offset = 0;
+    layout->attributes[attribute].stream = AEMVertexStream_Vertices;
+    layout->attributes[attribute].normalized = false;
+  }
+
+  if (!(vertex_format & AEM_VERTEX_FORMAT_QUANTIZED))
+  {
+    set_attribute(layout, position_stream, AEMVertexAttribute_Position, AEMVertexAttributeType_Float, 3, false);
+    set_attribute(layout, shading_stream, AEMVertexAttribute_Normal, AEMVertexAttributeType_Float, 3, false);
+    set_attribute(layout, shading_stream, AEMVertexAttribute_Tangent, AEMVertexAttributeType_Float, 3, false);
+    set_attribute(layout, shading_stream, AEMVertexAttribute_Bitangent, AEMVertexAttributeType_Float, 3, false);
+    set_attribute(layout, shading_stream, AEMVertexAttribute_UV, AEMVertexAttributeType_Float, 2, false);
+    set_attribute(layout, position_stream, AEMVertexAttribute_JointIndices, AEMVertexAttributeType_Int32, 4, false);
+    set_attribute(layout, position_stream, AEMVertexAttribute_JointWeights, AEMVertexAttributeType_Float, 4, false);
+    return;
+  }
+
+  set_attribute(layout, position_stream, AEMVertexAttribute_Position, AEMVertexAttributeType_Float, 3, false);
+
+  // Octahedral encoding, the tangent also holds the sign of the bitangent in its third component
+  set_attribute(layout, shading_stream, AEMVertexAttribute_Normal, AEMVertexAttributeType_Int16, 2, true);
+  set_attribute(layout, shading_stream, AEMVertexAttribute_Tangent, AEMVertexAttributeType_Int8, 4, true);
+
+  if (vertex_format & AEM_VERTEX_FORMAT_UV_UNORM16)
+  {
+    set_attribute(layout, shading_stream, AEMVertexAttribute_UV, AEMVertexAttributeType_UInt16, 2, true);
+  }
+  else
+  {
+    set_attribute(layout, shading_stream, AEMVertexAttribute_UV, AEMVertexAttributeType_HalfFloat, 2, false);
+  }
+
+  if (vertex_format & AEM_VERTEX_FORMAT_JOINTS_UINT16)
+  {
+    set_attribute(layout, position_stream, AEMVertexAttribute_JointIndices, AEMVertexAttributeType_UInt16, 4, false);
+  }
+  else
+  {
+    set_attribute(layout, position_stream, AEMVertexAttribute_JointIndices, AEMVertexAttributeType_UInt8, 4, false);
+  }
+
+  set_attribute(layout, position_stream, AEMVertexAttribute_JointWeights, AEMVertexAttributeType_UInt8, 4, true);
+}
+
+uint32_t aem_get_vertex_size(uint32_t vertex_format, enum AEMVertexStream stream)
+{
+  struct AEMVertexLayout layout;
+  aem_get_vertex_layout(vertex_format, &layout);
+  return layout.strides[stream];
+}
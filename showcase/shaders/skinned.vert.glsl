@@ -10,10 +10,19 @@ uniform mat4 view;
 uniform mat4 proj;
 uniform samplerBuffer joint_transform_tex;
 
+// Matches AEMJointTransformFormat
+const int JOINT_TRANSFORM_FORMAT_MATRIX_4X4 = 0;
+const int JOINT_TRANSFORM_FORMAT_MATRIX_3X4 = 1;
+const int JOINT_TRANSFORM_FORMAT_DUAL_QUATERNION = 2;
+uniform int joint_transform_format;
+
+const int VERTEX_FORMAT_QUANTIZED = 1; // Matches AEM_VERTEX_FORMAT_QUANTIZED
+uniform int vertex_format;
+
 layout(location = 0) in vec3 in_position;
-layout(location = 1) in vec3 in_normal;
-layout(location = 2) in vec3 in_tangent;
-layout(location = 3) in vec3 in_bitangent;
+layout(location = 1) in vec3 in_normal;    // Octahedral-encoded in xy if quantized
+layout(location = 2) in vec4 in_tangent;   // Octahedral-encoded in xy and bitangent sign in z if quantized
+layout(location = 3) in vec3 in_bitangent; // Not used if quantized
 layout(location = 4) in vec2 in_uv;
 layout(location = 5) in ivec4 in_joint_indices;
 layout(location = 6) in vec4 in_joint_weights;
@@ -28,6 +37,16 @@ out VERT_TO_FRAG
 } o;
 
 mat4 get_joint_transform(int index) {
+    if (joint_transform_format == JOINT_TRANSFORM_FORMAT_MATRIX_3X4) {
+      // Rows of the matrix, the bottom row is always the same
+      return transpose(mat4(
+          texelFetch(joint_transform_tex, index * 3 + 0),
+          texelFetch(joint_transform_tex, index * 3 + 1),
+          texelFetch(joint_transform_tex, index * 3 + 2),
+          vec4(0.0, 0.0, 0.0, 1.0)
+      ));
+    }
+
     return mat4(
         texelFetch(joint_transform_tex, index * 4 + 0),
         texelFetch(joint_transform_tex, index * 4 + 1),
@@ -36,28 +55,83 @@ mat4 get_joint_transform(int index) {
     );
 }
 
+// Blends the dual quaternions of the joints and turns the result into a matrix
+mat4 get_blended_dual_quaternion_transform(ivec4 indices, vec4 weights) {
+  vec4 first_real = texelFetch(joint_transform_tex, indices[0] * 2 + 0);
+  vec4 real = vec4(0.0);
+  vec4 dual = vec4(0.0);
+  for (int i = 0; i < 4; ++i)
+  {
+    vec4 joint_real = texelFetch(joint_transform_tex, indices[i] * 2 + 0);
+    vec4 joint_dual = texelFetch(joint_transform_tex, indices[i] * 2 + 1);
+
+    // Blend along the shorter path, q and -q are the same rotation
+    float weight = dot(joint_real, first_real) < 0.0 ? -weights[i] : weights[i];
+    real += joint_real * weight;
+    dual += joint_dual * weight;
+  }
+
+  float length_inverse = 1.0 / length(real);
+  real *= length_inverse;
+  dual *= length_inverse;
+
+  vec3 r = real.xyz;
+  float w = real.w;
+  mat3 rotation = mat3(
+      1.0 - 2.0 * (r.y * r.y + r.z * r.z), 2.0 * (r.x * r.y + w * r.z), 2.0 * (r.x * r.z - w * r.y),
+      2.0 * (r.x * r.y - w * r.z), 1.0 - 2.0 * (r.x * r.x + r.z * r.z), 2.0 * (r.y * r.z + w * r.x),
+      2.0 * (r.x * r.z + w * r.y), 2.0 * (r.y * r.z - w * r.x), 1.0 - 2.0 * (r.x * r.x + r.y * r.y)
+  );
+
+  mat4 transform = mat4(rotation);
+  transform[3] = vec4(2.0 * (w * dual.xyz - dual.w * r + cross(r, dual.xyz)), 1.0);
+  return transform;
+}
+
+vec3 decode_octahedral(vec2 e) {
+  vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-v.z, 0.0);
+  v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+  return normalize(v);
+}
+
 void main()
 {
+  vec3 normal = in_normal;
+  vec3 tangent = in_tangent.xyz;
+  vec3 bitangent = in_bitangent;
+  if ((vertex_format & VERTEX_FORMAT_QUANTIZED) != 0) {
+    normal = decode_octahedral(in_normal.xy);
+    tangent = decode_octahedral(in_tangent.xy);
+    bitangent = cross(normal, tangent) * in_tangent.z;
+  }
+
+  // Unskinned vertices have no weights, quantized joint indices are unsigned and can't be negative
   mat4 joint_transform = mat4(1.0);
-  if (in_joint_indices[0] >= 0) {
-    joint_transform = get_joint_transform(in_joint_indices[0]) * in_joint_weights[0];
-    for (int i = 1; i < 4; ++i)
-    {
-      joint_transform += get_joint_transform(in_joint_indices[i]) * in_joint_weights[i];
+  if (dot(in_joint_weights, vec4(1.0)) > 0.0) {
+    if (joint_transform_format == JOINT_TRANSFORM_FORMAT_DUAL_QUATERNION) {
+      joint_transform = get_blended_dual_quaternion_transform(in_joint_indices, in_joint_weights);
+    }
+    else {
+      joint_transform = get_joint_transform(in_joint_indices[0]) * in_joint_weights[0];
+      for (int i = 1; i < 4; ++i)
+      {
+        joint_transform += get_joint_transform(in_joint_indices[i]) * in_joint_weights[i];
+      }
     }
   }
 
   o.position = (world * joint_transform * vec4(in_position, 1)).xyz;
 
   if (normals_mode == NORMALS_MODE_WORLD_SPACE) {
-    o.normal = normalize((world * joint_transform * vec4(in_normal, 0)).xyz);
+    o.normal = normalize((world * joint_transform * vec4(normal, 0)).xyz);
   }
   else {
-    o.normal = normalize((view * world * joint_transform * vec4(in_normal, 0)).xyz);
+    o.normal = normalize((view * world * joint_transform * vec4(normal, 0)).xyz);
 
   }
-  o.tangent = normalize((world * joint_transform * vec4(in_tangent, 0)).xyz);
-  o.bitangent = normalize((world * joint_transform * vec4(in_bitangent, 0)).xyz);
+  o.tangent = normalize((world * joint_transform * vec4(tangent, 0)).xyz);
+  o.bitangent = normalize((world * joint_transform * vec4(bitangent, 0)).xyz);
 
   o.uv = in_uv;
   
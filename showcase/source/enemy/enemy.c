@@ -12,6 +12,7 @@
 #include "map.h"
 #include "model_manager.h"
 #include "preferences.h"
+#include "renderer/model_renderer.h"
 #include "sound.h"
 
 #include <aem/animation_mixer.h>
@@ -26,6 +27,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#define ENEMY_MODEL_FILENAME "models/soldier.aem"
+
 #define ENEMY_COLLIDER_RADIUS 0.5f
 #define ENEMY_COLLIDER_HEIGHT 1.8f
 
@@ -57,7 +60,8 @@ static enum EnemyState state;
 static const struct Preferences* preferences = NULL;
 
 static GLuint joint_transform_buffer, joint_transform_texture;
-static mat4* joint_transforms;
+static float* joint_transforms;
+static uint32_t joint_transforms_size; // In bytes
 
 static struct AEMAnimationMixer* mixer;
 
@@ -92,11 +96,16 @@ static void respawn_enemy(bool play_sound)
   enter_enemy_state_walk(true);
 }
 
+void request_enemy()
+{
+  request_model(ENEMY_MODEL_FILENAME);
+}
+
 bool load_enemy(const struct Preferences* preferences_)
 {
   preferences = preferences_;
 
-  render_info = load_model("models/soldier.aem");
+  render_info = load_model(ENEMY_MODEL_FILENAME);
   if (!render_info)
   {
     return false;
@@ -112,8 +121,8 @@ bool load_enemy(const struct Preferences* preferences_)
     return false;
   }
 
-  aem_set_animation_mixer_enabled(mixer, true);
   aem_set_animation_mixer_blend_speed(mixer, 4.0f);
+  aem_set_animation_mixer_joint_transform_format(mixer, model_renderer_get_joint_transform_format());
 
   load_enemy_state_walk(preferences, &state, render_info->model, mixer);
   load_enemy_state_aim(preferences, &state, mixer);
@@ -123,16 +132,17 @@ bool load_enemy(const struct Preferences* preferences_)
 
   // Enable skeletal animations
   {
-    joint_transforms = malloc(joint_count * sizeof(*joint_transforms));
+    joint_transforms_size =
+      sizeof(float) * aem_get_joint_transform_size(model_renderer_get_joint_transform_format()) * joint_count;
+    joint_transforms = malloc(joint_transforms_size);
     assert(joint_transforms);
 
-    for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
-    {
-      glm_mat4_identity(joint_transforms[joint_index]);
-    }
+    // Start out in the bind pose, which a mixer that is not enabled yet produces
+    aem_update_animation(render_info->model, mixer, 0.0f, joint_transforms);
+    aem_set_animation_mixer_enabled(mixer, true);
 
     glBindBuffer(GL_TEXTURE_BUFFER, joint_transform_buffer);
-    glBufferData(GL_TEXTURE_BUFFER, sizeof(mat4) * joint_count, NULL, GL_DYNAMIC_DRAW);
+    glBufferData(GL_TEXTURE_BUFFER, joint_transforms_size, NULL, GL_DYNAMIC_DRAW);
 
     glBindTexture(GL_TEXTURE_BUFFER, joint_transform_texture);
     glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, joint_transform_buffer);
@@ -315,15 +325,14 @@ void update_enemy(float delta_time)
   }
 
   // Always update animations and hitboxes
-  aem_update_animation(render_info->model, mixer, delta_time, **joint_transforms);
+  aem_update_animation(render_info->model, mixer, delta_time, joint_transforms);
   update_hitboxes();
 }
 
 void prepare_enemy_rendering()
 {
   glBindBuffer(GL_TEXTURE_BUFFER, joint_transform_buffer);
-  glBufferData(GL_TEXTURE_BUFFER, sizeof(mat4) * aem_get_model_joint_count(render_info->model), joint_transforms,
-               GL_DYNAMIC_DRAW);
+  glBufferData(GL_TEXTURE_BUFFER, joint_transforms_size, joint_transforms, GL_DYNAMIC_DRAW);
 
   // Joint transform texture
   glActiveTexture(GL_TEXTURE0);
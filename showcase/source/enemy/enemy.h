@@ -6,6 +6,7 @@
 
 struct ModelRenderInfo;
 
+void request_enemy(); // Starts loading the enemy model in the background
 bool load_enemy(const struct Preferences* preferences);
 
 void update_enemy(float delta_time);
@@ -10,6 +10,11 @@
 
 #define MAP_MAX_PART_COUNT 3
 
+#define TEST_LEVEL_FILENAME "models/test_level.aem"
+#define SPONZA_PART_1_FILENAME "models/sponza_single_b1.aem"
+#define SPONZA_PART_2_FILENAME "models/sponza_single_b2.aem"
+#define SPONZA_PART_3_FILENAME "models/sponza_single_b3.aem"
+
 static enum Map current_map;
 
 static struct ModelRenderInfo* map_parts[MAP_MAX_PART_COUNT];
@@ -17,9 +22,23 @@ static uint32_t map_part_count;
 
 static uint32_t collision_index_count = 0;
 
-static float* collision_vertices = NULL;
+static vec3* collision_positions = NULL; // Only the positions of the collision vertices, tightly packed
 static uint32_t* collision_indices = NULL;
 
+void request_map(enum Map map)
+{
+  if (map == Map_TestLevel)
+  {
+    request_model(TEST_LEVEL_FILENAME);
+  }
+  else if (map == Map_Sponza)
+  {
+    request_model(SPONZA_PART_1_FILENAME);
+    request_model(SPONZA_PART_2_FILENAME);
+    request_model(SPONZA_PART_3_FILENAME);
+  }
+}
+
 bool load_map(enum Map map)
 {
   current_map = map;
@@ -29,7 +48,7 @@ bool load_map(enum Map map)
   // Load visual models
   if (map == Map_TestLevel)
   {
-    map_parts[0] = load_model("models/test_level.aem");
+    map_parts[0] = load_model(TEST_LEVEL_FILENAME);
 
     if (!map_parts[0])
     {
@@ -40,9 +59,9 @@ bool load_map(enum Map map)
   }
   else if (map == Map_Sponza)
   {
-    map_parts[0] = load_model("models/sponza_single_b1.aem");
-    map_parts[1] = load_model("models/sponza_single_b2.aem");
-    map_parts[2] = load_model("models/sponza_single_b3.aem");
+    map_parts[0] = load_model(SPONZA_PART_1_FILENAME);
+    map_parts[1] = load_model(SPONZA_PART_2_FILENAME);
+    map_parts[2] = load_model(SPONZA_PART_3_FILENAME);
 
     if (!map_parts[0] || !map_parts[1] || !map_parts[2])
     {
@@ -53,37 +72,78 @@ bool load_map(enum Map map)
   }
 
   {
-    // Load collision model
+    // Load collision model, only its geometry is needed
     struct AEMModel* collision_model = NULL;
+    const struct AEMModelLoadOptions collision_load_options = { AEM_LOAD_GEOMETRY, 0 };
 
     if (map == Map_TestLevel)
     {
-      if (aem_load_model("models/test_level.aem", &collision_model) != AEMModelResult_Success)
+      if (aem_load_model_with_options("models/test_level.aem", &collision_load_options, &collision_model) !=
+          AEMModelResult_Success)
       {
         return false;
       }
     }
     else if (map == Map_Sponza)
     {
-      if (aem_load_model("models/sponza_single_c.aem", &collision_model) != AEMModelResult_Success)
+      if (aem_load_model_with_options("models/sponza_single_c.aem", &collision_load_options, &collision_model) !=
+          AEMModelResult_Success)
       {
         return false;
       }
     }
 
-    // Copy vertices into collision_vertices
+    // Copy vertex positions into collision_positions, they are never quantized
     {
+      struct AEMVertexLayout vertex_layout;
+      aem_get_vertex_layout(aem_get_model_vertex_format(collision_model), &vertex_layout);
+      const struct AEMVertexAttributeLayout* position = &vertex_layout.attributes[AEMVertexAttribute_Position];
+
+      // Split vertex formats keep the positions in a compact stream of their own
+      const uint32_t stride = vertex_layout.strides[position->stream];
+      const uint8_t* vertices = position->stream == AEMVertexStream_Positions ?
+                                  aem_get_model_position_buffer(collision_model) :
+                                  aem_get_model_vertex_buffer(collision_model);
+
       const uint32_t collision_vertex_count = aem_get_model_vertex_count(collision_model);
-      collision_vertices = malloc(AEM_VERTEX_SIZE * collision_vertex_count);
-      memcpy(collision_vertices, aem_get_model_vertex_buffer(collision_model),
-             AEM_VERTEX_SIZE * collision_vertex_count);
+      collision_positions = malloc(sizeof(vec3) * collision_vertex_count);
+      for (uint32_t vertex_index = 0; vertex_index < collision_vertex_count; ++vertex_index)
+      {
+        memcpy(collision_positions[vertex_index], vertices + vertex_index * stride + position->offset, sizeof(vec3));
+      }
     }
 
-    // Copy indices into collision_indices and remember the index count
+    // Expand the indices of all meshes into 32-bit collision_indices and remember the index count
     {
-      collision_index_count = aem_get_model_index_count(collision_model);
-      collision_indices = malloc(AEM_INDEX_SIZE * collision_index_count);
-      memcpy(collision_indices, aem_get_model_index_buffer(collision_model), AEM_INDEX_SIZE * collision_index_count);
+      const uint32_t mesh_count = aem_get_model_mesh_count(collision_model);
+
+      // Only the meshes themselves collide, not their LODs
+      collision_index_count = 0;
+      for (uint32_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+      {
+        collision_index_count += aem_get_model_mesh(collision_model, mesh_index)->index_count;
+      }
+      collision_indices = malloc(sizeof(*collision_indices) * collision_index_count);
+
+      const uint8_t* index_buffer = aem_get_model_index_buffer(collision_model);
+      uint32_t* collision_index = collision_indices;
+
+      for (uint32_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+      {
+        const struct AEMMesh* mesh = aem_get_model_mesh(collision_model, mesh_index);
+        const uint8_t* indices = index_buffer + (uint64_t)mesh->first_index * aem_get_index_size(mesh->index_type);
+        for (uint32_t index = 0; index < mesh->index_count; ++index)
+        {
+          if (mesh->index_type == AEMIndexType_UInt16)
+          {
+            *collision_index++ = ((const uint16_t*)indices)[index] + mesh->base_vertex;
+          }
+          else
+          {
+            *collision_index++ = ((const uint32_t*)indices)[index] + mesh->base_vertex;
+          }
+        }
+      }
     }
 
     // Clean up the collision model
@@ -96,7 +156,7 @@ bool load_map(enum Map map)
 
 void free_map()
 {
-  free(collision_vertices);
+  free(collision_positions);
   free(collision_indices);
 }
 
@@ -121,9 +181,9 @@ void get_map_collision_triangle(uint32_t first_index, vec3 v0, vec3 v1, vec3 v2)
   const uint32_t i1 = collision_indices[first_index + 1];
   const uint32_t i2 = collision_indices[first_index + 2];
 
-  glm_vec3_copy(&collision_vertices[i0 * 22], v0);
-  glm_vec3_copy(&collision_vertices[i1 * 22], v1);
-  glm_vec3_copy(&collision_vertices[i2 * 22], v2);
+  glm_vec3_copy(collision_positions[i0], v0);
+  glm_vec3_copy(collision_positions[i1], v1);
+  glm_vec3_copy(collision_positions[i2], v2);
 }
 
 void get_current_map_player_spawn(vec3 position, float* yaw)
@@ -13,6 +13,7 @@ enum Map
   Map_Sponza
 };
 
+void request_map(enum Map map); // Starts loading the models of a map in the background
 bool load_map(enum Map map);
 
 void free_map();
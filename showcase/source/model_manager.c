@@ -1,5 +1,7 @@
 #include "model_manager.h"
 
+#include "window.h"
+
 #include <aem/model.h>
 
 #include <assert.h>
@@ -10,6 +12,38 @@ static uint32_t model_index, model_count;
 
 static struct ModelRenderInfo* model_render_infos = NULL;
 
+struct ModelRequest
+{
+  const char* filename;
+  struct AEMModelLoad* load; // NULL once the model has been picked up
+};
+
+static uint32_t model_request_count;
+static struct ModelRequest* model_requests = NULL;
+
+// Combined progress of the model that is being waited for and all other models that are still loading
+static float get_model_loading_progress(struct AEMModelLoad* current_load)
+{
+  struct AEMModelLoadProgress progress;
+  aem_poll_loading_model(current_load, &progress);
+
+  uint64_t loaded_size = progress.loaded_size, total_size = progress.total_size;
+  for (uint32_t request_index = 0; request_index < model_request_count; ++request_index)
+  {
+    const struct ModelRequest* request = &model_requests[request_index];
+    if (!request->load)
+    {
+      continue;
+    }
+
+    aem_poll_loading_model(request->load, &progress);
+    loaded_size += progress.loaded_size;
+    total_size += progress.total_size;
+  }
+
+  return total_size > 0 ? (float)loaded_size / (float)total_size : 0.0f;
+}
+
 void prepare_model_loading(uint32_t model_count_)
 {
   model_index = 0;
@@ -22,6 +56,27 @@ void prepare_model_loading(uint32_t model_count_)
     assert(model_render_infos);
     memset(model_render_infos, 0, size);
   }
+
+  // Allocate model requests
+  {
+    model_request_count = 0;
+    model_requests = malloc(sizeof(*model_requests) * model_count);
+    assert(model_requests);
+  }
+}
+
+void request_model(const char* filename)
+{
+  assert(model_request_count < model_count);
+
+  struct ModelRequest* request = &model_requests[model_request_count];
+  if (aem_begin_loading_model(filename, NULL, NULL, NULL, &request->load) != AEMModelResult_Success)
+  {
+    return; // Loading it again in load_model reports the error
+  }
+
+  request->filename = filename;
+  ++model_request_count;
 }
 
 struct ModelRenderInfo* load_model(const char* filename)
@@ -29,13 +84,39 @@ struct ModelRenderInfo* load_model(const char* filename)
   struct ModelRenderInfo* mri = &model_render_infos[model_index++];
   struct AEMModel** model = &mri->model;
 
-  if (aem_load_model(filename, model) != AEMModelResult_Success)
+  struct AEMModelLoad* load = NULL;
+  for (uint32_t request_index = 0; request_index < model_request_count; ++request_index)
+  {
+    struct ModelRequest* request = &model_requests[request_index];
+    if (request->load && strcmp(request->filename, filename) == 0)
+    {
+      load = request->load;
+      request->load = NULL;
+      break;
+    }
+  }
+
+  if (!load)
+  {
+    if (aem_begin_loading_model(filename, NULL, NULL, NULL, &load) != AEMModelResult_Success)
+    {
+      return NULL;
+    }
+  }
+
+  // Keep the window responsive while the model is still loading, other requested models keep loading too
+  while (aem_poll_loading_model(load, NULL) == AEMModelLoadState_Loading)
+  {
+    render_loading_screen(get_model_loading_progress(load));
+  }
+
+  if (aem_end_loading_model(load, model) != AEMModelResult_Success)
   {
     return NULL;
   }
 
   mri->vertex_count = aem_get_model_vertex_count(*model);
-  mri->index_count = aem_get_model_index_count(*model);
+  mri->index_buffer_size = aem_get_model_index_buffer_size(*model);
   mri->textures = aem_get_model_textures(*model, &mri->texture_count);
 
   model_renderer_add_model(mri);
@@ -79,5 +160,25 @@ void free_models()
     aem_free_model(model);
   }
 
+  // Requests that have never been picked up still need to be ended
+  for (uint32_t request_index = 0; request_index < model_request_count; ++request_index)
+  {
+    struct AEMModelLoad* load = model_requests[request_index].load;
+    if (!load)
+    {
+      continue;
+    }
+
+    aem_cancel_loading_model(load);
+
+    struct AEMModel* model;
+    if (aem_end_loading_model(load, &model) == AEMModelResult_Success)
+    {
+      aem_finish_loading_model(model);
+      aem_free_model(model);
+    }
+  }
+
+  free(model_requests);
   free(model_render_infos);
 }
\ No newline at end of file
@@ -10,11 +10,13 @@ struct ModelRenderInfo
   struct AEMModel* model;
   const struct AEMTexture* textures;
 
-  uint32_t vertex_count, index_count, texture_count;
-  uint32_t first_vertex, first_index, first_texture;
+  uint32_t vertex_count, texture_count;
+  uint32_t first_vertex, first_texture;
+  uint64_t index_buffer_size, index_buffer_offset; // In bytes, the indices of a model can be of mixed types
 };
 
 void prepare_model_loading(uint32_t model_count);
+void request_model(const char* filename); // Starts loading a model in the background, to be picked up by load_model
 struct ModelRenderInfo* load_model(const char* filename);
 void finish_model_loading();
 
@@ -8,6 +8,7 @@
 #include "model_manager.h"
 #include "particle_manager.h"
 #include "preferences.h"
+#include "renderer/model_renderer.h"
 #include "sound.h"
 #include "tracer_manager.h"
 
@@ -23,6 +24,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#define VIEW_MODEL_FILENAME "models/cz.aem"
+
 #define IDLE_ANIMATION_INDEX 1
 #define WALK_ANIMATION_INDEX 2   // AK: 9
 #define SHOOT_ANIMATION_INDEX 4  // AK: 2
@@ -37,7 +40,8 @@
 static struct ModelRenderInfo* render_info = NULL;
 
 static GLuint joint_transform_buffer, joint_transform_texture;
-static mat4* joint_transforms;
+static float* joint_transforms;
+static uint32_t joint_transforms_size; // In bytes
 
 static struct AEMAnimationMixer* mixer;
 static struct AEMAnimationChannel *idle_channel, *walk_channel, *reload_channel, *shoot_channel;
@@ -64,9 +68,14 @@ static void view_model_get_muzzleflash_world_matrix(struct Preferences* preferen
   glm_translate(muzzleflash_world_matrix, (vec3){ -0.1f, -0.05f, -0.01f });
 }
 
+void request_view_model()
+{
+  request_model(VIEW_MODEL_FILENAME);
+}
+
 bool load_view_model()
 {
-  render_info = load_model("models/cz.aem");
+  render_info = load_model(VIEW_MODEL_FILENAME);
   if (!render_info)
   {
     return false;
@@ -82,7 +91,7 @@ bool load_view_model()
     return false;
   }
 
-  aem_set_animation_mixer_enabled(mixer, true);
+  aem_set_animation_mixer_joint_transform_format(mixer, model_renderer_get_joint_transform_format());
 
   idle_channel = aem_get_animation_mixer_channel(mixer, 0);
 
@@ -108,16 +117,17 @@ bool load_view_model()
     shoot_channel->is_looping = false;
   }
 
-  joint_transforms = malloc(joint_count * sizeof(mat4));
+  joint_transforms_size =
+    sizeof(float) * aem_get_joint_transform_size(model_renderer_get_joint_transform_format()) * joint_count;
+  joint_transforms = malloc(joint_transforms_size);
   assert(joint_transforms);
 
-  for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
-  {
-    glm_mat4_identity(joint_transforms[joint_index]);
-  }
+  // Start out in the bind pose, which a mixer that is not enabled yet produces
+  aem_update_animation(render_info->model, mixer, 0.0f, joint_transforms);
+  aem_set_animation_mixer_enabled(mixer, true);
 
   glBindBuffer(GL_TEXTURE_BUFFER, joint_transform_buffer);
-  glBufferData(GL_TEXTURE_BUFFER, sizeof(mat4) * joint_count, NULL, GL_DYNAMIC_DRAW);
+  glBufferData(GL_TEXTURE_BUFFER, joint_transforms_size, NULL, GL_DYNAMIC_DRAW);
 
   glBindTexture(GL_TEXTURE_BUFFER, joint_transform_texture);
   glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, joint_transform_buffer);
@@ -310,7 +320,7 @@ void update_view_model(struct Preferences* preferences, bool firing_enabled, boo
     }
   }
 
-  aem_update_animation(render_info->model, mixer, delta_time, **joint_transforms);
+  aem_update_animation(render_info->model, mixer, delta_time, joint_transforms);
 
   // Footstep sounds
   if (moving && !preferences->no_clip)
@@ -376,8 +386,7 @@ void view_model_get_world_matrix(struct Preferences* preferences, mat4 world_mat
 void prepare_view_model_rendering()
 {
   glBindBuffer(GL_TEXTURE_BUFFER, joint_transform_buffer);
-  glBufferData(GL_TEXTURE_BUFFER, sizeof(mat4) * aem_get_model_joint_count(render_info->model), joint_transforms,
-               GL_DYNAMIC_DRAW);
+  glBufferData(GL_TEXTURE_BUFFER, joint_transforms_size, joint_transforms, GL_DYNAMIC_DRAW);
 
   // Joint transform texture
   glActiveTexture(GL_TEXTURE0);
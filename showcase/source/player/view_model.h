@@ -6,6 +6,7 @@
 
 struct ModelRenderInfo;
 
+void request_view_model(); // Starts loading the view model in the background
 bool load_view_model();
 
 void update_view_model(struct Preferences* preferences, bool firing_enabled, bool moving, float delta_time);
@@ -1,5 +1,7 @@
 #include "depth_pipeline.h"
 
+#include "renderer/model_renderer.h"
+
 #include <util/util.h>
 
 #include <glad/gl.h>
@@ -42,6 +44,13 @@ bool load_depth_pipeline()
     const GLint normals_mode_uniform_location = get_uniform_location(shader_program, "normals_mode");
     glUniform1i(normals_mode_uniform_location, 1); // Produce view-space normals
 
+    const GLint vertex_format_uniform_location = get_uniform_location(shader_program, "vertex_format");
+    glUniform1i(vertex_format_uniform_location, (GLint)model_renderer_get_vertex_format());
+
+    const GLint joint_transform_format_uniform_location =
+      get_uniform_location(shader_program, "joint_transform_format");
+    glUniform1i(joint_transform_format_uniform_location, (GLint)model_renderer_get_joint_transform_format());
+
     const GLint joint_transform_tex_uniform_location = get_uniform_location(shader_program, "joint_transform_tex");
     glUniform1i(joint_transform_tex_uniform_location, 0);
   }
@@ -1,5 +1,7 @@
 #include "main_pipeline.h"
 
+#include "renderer/model_renderer.h"
+
 #include <util/util.h>
 
 #include <cglm/vec3.h>
@@ -58,6 +60,13 @@ bool load_main_pipeline()
       const GLint normals_mode_uniform_location = get_uniform_location(shader_program, "normals_mode");
       glUniform1i(normals_mode_uniform_location, 0); // Produce world-space normals
 
+      const GLint vertex_format_uniform_location = get_uniform_location(shader_program, "vertex_format");
+      glUniform1i(vertex_format_uniform_location, (GLint)model_renderer_get_vertex_format());
+
+      const GLint joint_transform_format_uniform_location =
+        get_uniform_location(shader_program, "joint_transform_format");
+      glUniform1i(joint_transform_format_uniform_location, (GLint)model_renderer_get_joint_transform_format());
+
       const GLint joint_transform_tex_uniform_location = get_uniform_location(shader_program, "joint_transform_tex");
       glUniform1i(joint_transform_tex_uniform_location, 0);
 
@@ -9,7 +9,6 @@
 #include <string.h>
 
 static struct AEMModel* tracer_model = NULL;
-static uint32_t tracer_index_count = 0;
 
 static GLuint vao, vertex_buffer, index_buffer;
 static GLuint instance_starts, instance_ends;
@@ -22,8 +21,6 @@ bool load_tracer_renderer()
     return false;
   }
 
-  tracer_index_count = aem_get_model_index_count(tracer_model);
-
   glGenVertexArrays(1, &vao);
   glBindVertexArray(vao);
 
@@ -32,16 +29,23 @@ bool load_tracer_renderer()
   glGenBuffers(1, &instance_starts);
   glGenBuffers(1, &instance_ends);
 
+  // Tracers only need positions, so only the stream that holds them is uploaded
+  struct AEMVertexLayout vertex_layout;
+  aem_get_vertex_layout(aem_get_model_vertex_format(tracer_model), &vertex_layout);
+  const struct AEMVertexAttributeLayout* position = &vertex_layout.attributes[AEMVertexAttribute_Position];
+  const uint32_t vertex_size = vertex_layout.strides[position->stream];
+  const void* positions = position->stream == AEMVertexStream_Positions ? aem_get_model_position_buffer(tracer_model) :
+                                                                           aem_get_model_vertex_buffer(tracer_model);
+
   glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-  glBufferData(GL_ARRAY_BUFFER, aem_get_model_vertex_count(tracer_model) * AEM_VERTEX_SIZE,
-               aem_get_model_vertex_buffer(tracer_model), GL_STATIC_DRAW);
+  glBufferData(GL_ARRAY_BUFFER, aem_get_model_vertex_count(tracer_model) * vertex_size, positions, GL_STATIC_DRAW);
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, aem_get_model_index_count(tracer_model) * AEM_INDEX_SIZE,
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, aem_get_model_index_buffer_size(tracer_model),
                aem_get_model_index_buffer(tracer_model), GL_STATIC_DRAW);
 
   glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(sizeof(float) * 0));
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertex_size, (void*)(uintptr_t)position->offset); // Never quantized
 
   glBindBuffer(GL_ARRAY_BUFFER, instance_starts);
   glEnableVertexAttribArray(1);
@@ -89,5 +93,13 @@ void render_tracers(vec3* starts, vec3* ends, uint32_t tracer_count)
   glBindBuffer(GL_ARRAY_BUFFER, instance_ends);
   glBufferData(GL_ARRAY_BUFFER, sizeof(ends[0]) * tracer_count, ends, GL_DYNAMIC_DRAW);
 
-  glDrawElementsInstanced(GL_TRIANGLES, tracer_index_count, GL_UNSIGNED_INT, 0, tracer_count);
+  const uint32_t mesh_count = aem_get_model_mesh_count(tracer_model);
+  for (uint32_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+  {
+    const struct AEMMesh* mesh = aem_get_model_mesh(tracer_model, mesh_index);
+    const GLenum index_type = mesh->index_type == AEMIndexType_UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    const uint64_t index_offset = (uint64_t)mesh->first_index * aem_get_index_size(mesh->index_type);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh->index_count, index_type, (void*)(uintptr_t)index_offset,
+                                      tracer_count, mesh->base_vertex);
+  }
 }
\ No newline at end of file
@@ -4,40 +4,66 @@
 
 #include <aem/model.h>
 
+#include <util/util.h>
+
 #include <glad/gl.h>
 
 #include <assert.h>
 #include <stdlib.h>
 
-static GLuint vertex_array;
-static GLuint vertex_buffer, index_buffer;
-static uint32_t total_vertex_count = 0, total_index_count = 0, total_texture_count = 0;
+// Upload only the top three rows of the joint matrices, dual quaternions would be smaller still but drop any scale
+#define JOINT_TRANSFORM_FORMAT AEMJointTransformFormat_Matrix3x4
+
+static GLuint vertex_array, position_vertex_array; // The latter only has positions and skinning data bound
+static GLuint vertex_buffer, position_buffer, index_buffer;
+static uint32_t total_vertex_count = 0, total_texture_count = 0;
+static uint64_t total_index_buffer_size = 0;
 static GLuint* texture_handles = NULL;
 
+static struct AEMVertexLayout vertex_layout;
+static bool has_vertex_layout = false;
+
 void model_renderer_add_model(struct ModelRenderInfo* model_render_info)
 {
+  // All models share one vertex buffer and vertex array, so their vertex formats need to match
+  const uint32_t vertex_format = aem_get_model_vertex_format(model_render_info->model);
+  if (!has_vertex_layout)
+  {
+    aem_get_vertex_layout(vertex_format, &vertex_layout);
+    has_vertex_layout = true;
+  }
+  assert(vertex_format == vertex_layout.format);
+
   model_render_info->first_vertex = total_vertex_count;
-  model_render_info->first_index = total_index_count;
+  model_render_info->index_buffer_offset = total_index_buffer_size;
   model_render_info->first_texture = total_texture_count;
 
   total_vertex_count += model_render_info->vertex_count;
-  total_index_count += model_render_info->index_count;
+  // Keep the index buffer of every model aligned for 32-bit indices
+  total_index_buffer_size += (model_render_info->index_buffer_size + 3) & ~3ull;
   total_texture_count += model_render_info->texture_count;
 }
 
 void load_model_renderer()
 {
+  const uint32_t vertex_size = vertex_layout.strides[AEMVertexStream_Vertices];
+  const uint32_t position_size = vertex_layout.strides[AEMVertexStream_Positions];
+
   glGenVertexArrays(1, &vertex_array);
   glBindVertexArray(vertex_array);
 
   glGenBuffers(1, &vertex_buffer);
+  glGenBuffers(1, &position_buffer);
   glGenBuffers(1, &index_buffer);
 
+  glBindBuffer(GL_ARRAY_BUFFER, position_buffer);
+  glBufferData(GL_ARRAY_BUFFER, total_vertex_count * position_size, NULL, GL_STATIC_DRAW);
+
   glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+  glBufferData(GL_ARRAY_BUFFER, total_vertex_count * vertex_size, NULL, GL_STATIC_DRAW);
 
-  glBufferData(GL_ARRAY_BUFFER, total_vertex_count * AEM_VERTEX_SIZE, NULL, GL_STATIC_DRAW);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, total_index_count * AEM_INDEX_SIZE, NULL, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, total_index_buffer_size, NULL, GL_STATIC_DRAW);
 
   const uint32_t texture_handles_size = sizeof(*texture_handles) * total_texture_count;
   texture_handles = malloc(texture_handles_size);
@@ -52,10 +78,18 @@ void load_model_renderer()
       continue;
     }
 
-    glBufferSubData(GL_ARRAY_BUFFER, mri->first_vertex * AEM_VERTEX_SIZE, mri->vertex_count * AEM_VERTEX_SIZE,
+    glBufferSubData(GL_ARRAY_BUFFER, mri->first_vertex * vertex_size, mri->vertex_count * vertex_size,
                     aem_get_model_vertex_buffer(model));
 
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, mri->first_index * AEM_INDEX_SIZE, mri->index_count * AEM_INDEX_SIZE,
+    if (position_size > 0)
+    {
+      glBindBuffer(GL_ARRAY_BUFFER, position_buffer);
+      glBufferSubData(GL_ARRAY_BUFFER, mri->first_vertex * position_size, mri->vertex_count * position_size,
+                      aem_get_model_position_buffer(model));
+      glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    }
+
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, mri->index_buffer_offset, mri->index_buffer_size,
                     aem_get_model_index_buffer(model));
 
     for (uint32_t texture_index = 0; texture_index < mri->texture_count; ++texture_index)
@@ -65,35 +99,33 @@ void load_model_renderer()
   }
 
   // Apply the vertex definition
-  {
-    // Position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(0 * 4));
+  set_model_vertex_attributes(&vertex_layout, AEMVertexStream_Vertices);
 
-    // Normal
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(3 * 4));
-
-    // Tangent
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(6 * 4));
-
-    // Bitangent
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(9 * 4));
+  // Split vertex formats get a second vertex array for depth-only passes that doesn't fetch any shading attributes
+  if (position_size > 0)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, position_buffer);
+    set_model_vertex_attributes(&vertex_layout, AEMVertexStream_Positions);
 
-    // UV
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(12 * 4));
+    glGenVertexArrays(1, &position_vertex_array);
+    glBindVertexArray(position_vertex_array);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    set_model_vertex_attributes(&vertex_layout, AEMVertexStream_Positions);
+  }
+  else
+  {
+    position_vertex_array = vertex_array;
+  }
+}
 
-    // Joint indices
-    glEnableVertexAttribArray(5);
-    glVertexAttribIPointer(5, 4, GL_INT, AEM_VERTEX_SIZE, (void*)(14 * 4));
+uint32_t model_renderer_get_vertex_format()
+{
+  return vertex_layout.format;
+}
 
-    // Joint weights
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(18 * 4));
-  }
+enum AEMJointTransformFormat model_renderer_get_joint_transform_format()
+{
+  return JOINT_TRANSFORM_FORMAT;
 }
 
 void free_model_renderer()
@@ -102,14 +134,19 @@ void free_model_renderer()
   free(texture_handles);
 
   glDeleteBuffers(1, &vertex_buffer);
+  glDeleteBuffers(1, &position_buffer);
   glDeleteBuffers(1, &index_buffer);
 
+  if (position_vertex_array != vertex_array)
+  {
+    glDeleteVertexArrays(1, &position_vertex_array);
+  }
   glDeleteVertexArrays(1, &vertex_array);
 }
 
-void start_model_rendering()
+void start_model_rendering(enum ModelVertexInput vertex_input)
 {
-  glBindVertexArray(vertex_array);
+  glBindVertexArray(vertex_input == ModelVertexInput_PositionsOnly ? position_vertex_array : vertex_array);
 }
 
 void render_model(struct ModelRenderInfo* mri, enum ModelRenderMode mode)
@@ -141,8 +178,9 @@ void render_model(struct ModelRenderInfo* mri, enum ModelRenderMode mode)
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, texture_handles[mri->first_texture + material->pbr_texture_index]);
 
-    glDrawElementsBaseVertex(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT,
-                             (void*)(uintptr_t)((mri->first_index + mesh->first_index) * AEM_INDEX_SIZE),
-                             mri->first_vertex);
+    const GLenum index_type = mesh->index_type == AEMIndexType_UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    const uint64_t index_offset = mri->index_buffer_offset + mesh->first_index * aem_get_index_size(mesh->index_type);
+    glDrawElementsBaseVertex(GL_TRIANGLES, mesh->index_count, index_type, (void*)(uintptr_t)index_offset,
+                             mri->first_vertex + mesh->base_vertex);
   }
 }
\ No newline at end of file
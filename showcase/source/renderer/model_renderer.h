@@ -1,5 +1,9 @@
 #pragma once
 
+#include <aem/animation_mixer.h>
+
+#include <stdint.h>
+
 struct ModelRenderInfo;
 
 enum ModelRenderMode
@@ -9,10 +13,19 @@ enum ModelRenderMode
   ModelRenderMode_TransparentMeshesOnly
 };
 
+enum ModelVertexInput
+{
+  ModelVertexInput_AllAttributes,
+  ModelVertexInput_PositionsOnly // Positions and skinning data, for depth-only passes
+};
+
 void model_renderer_add_model(struct ModelRenderInfo* model_render_info);
 
 void load_model_renderer();
 void free_model_renderer();
 
-void start_model_rendering();
+uint32_t model_renderer_get_vertex_format(); // Shared by all models, combination of AEM_VERTEX_FORMAT_* flags
+enum AEMJointTransformFormat model_renderer_get_joint_transform_format(); // Shared by all skinned models
+
+void start_model_rendering(enum ModelVertexInput vertex_input);
 void render_model(struct ModelRenderInfo* model_render_info, enum ModelRenderMode mode);
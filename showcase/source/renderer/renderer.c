@@ -229,7 +229,7 @@ void free_renderer()
 
 static void render_shadow_pass()
 {
-  start_model_rendering();
+  start_model_rendering(ModelVertexInput_PositionsOnly);
 
   shadow_framebuffer_start_rendering();
   shadow_pipeline_start_rendering();
@@ -271,7 +271,7 @@ static void render_shadow_pass()
 
 static void render_forward_pass_early()
 {
-  start_model_rendering();
+  start_model_rendering(ModelVertexInput_AllAttributes);
 
   forward_framebuffer_start_rendering(ForwardFramebufferAttachment_ViewspaceNormalsTexture);
 
@@ -396,7 +396,7 @@ static void render_ssao_pass()
 
 static void render_forward_pass_late()
 {
-  start_model_rendering();
+  start_model_rendering(ModelVertexInput_AllAttributes);
 
   forward_framebuffer_start_rendering(ForwardFramebufferAttachment_HDRTexture);
 
@@ -526,7 +526,7 @@ static void render_forward_pass_late()
   // Main pipeline (view model)
   if (get_player_health() > 0.0f)
   {
-    start_model_rendering();
+    start_model_rendering(ModelVertexInput_AllAttributes);
     main_pipeline_start_rendering();
 
     glClear(GL_DEPTH_BUFFER_BIT); // Clear depth so view model never clips into level
@@ -1,6 +1,7 @@
 #include "shadow_pipeline.h"
 
 #include "camera.h"
+#include "renderer/model_renderer.h"
 
 #include <util/util.h>
 
@@ -41,6 +42,13 @@ bool load_shadow_pipeline()
     view_uniform_location = get_uniform_location(shader_program, "view");
     proj_uniform_location = get_uniform_location(shader_program, "proj");
 
+    const GLint vertex_format_uniform_location = get_uniform_location(shader_program, "vertex_format");
+    glUniform1i(vertex_format_uniform_location, (GLint)model_renderer_get_vertex_format());
+
+    const GLint joint_transform_format_uniform_location =
+      get_uniform_location(shader_program, "joint_transform_format");
+    glUniform1i(joint_transform_format_uniform_location, (GLint)model_renderer_get_joint_transform_format());
+
     const GLint joint_transform_tex_uniform_location = get_uniform_location(shader_program, "joint_transform_tex");
     glUniform1i(joint_transform_tex_uniform_location, 0);
   }
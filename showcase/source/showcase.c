@@ -44,6 +44,11 @@ int main(int argc, char* argv[])
   {
     prepare_model_loading(3 + 1 + 1); // Max 3 map models, 1 enemy model, 1 view weapon model
 
+    // Start reading all model files in the background so that later ones are ready by the time they are needed
+    request_map(Map_Sponza);
+    request_enemy();
+    request_view_model();
+
     if (!load_map(Map_Sponza))
     {
       printf("Failed to load map\n");
@@ -138,6 +138,22 @@ void refresh_window()
   glfwPollEvents();
 }
 
+void render_loading_screen(float progress)
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  // Draw the progress bar along the bottom edge by clearing a scissor rectangle
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(0, 0, (GLsizei)(width * progress), (GLsizei)(height / 100 + 1));
+  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glDisable(GL_SCISSOR_TEST);
+
+  refresh_window();
+}
+
 void free_window()
 {
   glfwTerminate();
@@ -22,5 +22,6 @@ bool should_window_close();
 void close_window();
 
 void refresh_window();
+void render_loading_screen(float progress); // Progress from 0 to 1, also refreshes the window
 
 void free_window();
\ No newline at end of file
@@ -1,12 +1,11 @@
 #pragma once
 
+#include <aem/model.h>
+
 #include <glad/gl.h>
 
 #include <stdbool.h>
 
-struct AEMModel;
-struct AEMTexture;
-
 // Filenames
 char* filename_from_filepath(char* filepath);   // Converter
 char* path_from_filepath(const char* filepath); // Converter and viewer
@@ -26,4 +25,8 @@ char* load_text_file(const char* filepath, long* length); // Converter and viewe
 void preprocess_list_file(char* list, long length); // Preprocess to eliminate whitespaces and skip comments (converter)
 
 // Textures
-GLuint load_model_texture(const struct AEMModel* model, const struct AEMTexture* texture);
\ No newline at end of file
+GLuint load_model_texture(const struct AEMModel* model, const struct AEMTexture* texture);
+
+// Vertices
+void set_model_vertex_attributes(const struct AEMVertexLayout* layout,
+                                 enum AEMVertexStream stream); // For the bound vertex array and buffer
\ No newline at end of file
@@ -58,7 +58,8 @@ static void aem_texture_to_gl_formats(const struct AEMTexture* texture, GLenum*
 
 GLuint load_model_texture(const struct AEMModel* model, const struct AEMTexture* texture)
 {
-  const uint8_t* data = (uint8_t*)aem_get_model_image_buffer(model);
+  uint32_t first_level;
+  const uint8_t* level_data = (uint8_t*)aem_get_model_texture_data(model, texture, &first_level);
 
   GLuint texture_handle;
   glGenTextures(1, &texture_handle);
@@ -68,9 +69,11 @@ GLuint load_model_texture(const struct AEMModel* model, const struct AEMTexture*
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  const uint8_t* level_data = &data[texture->offset];
+  // Skipped levels keep their level index so that they can be streamed in later by lowering the base level
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, first_level);
+
   const uint32_t level_count = aem_get_model_texture_level_count(texture->width, texture->height);
-  for (uint32_t level_index = 0; level_index < level_count; ++level_index)
+  for (uint32_t level_index = first_level; level_index < level_count; ++level_index)
   {
     uint32_t level_width, level_height;
     uint32_t level_size;
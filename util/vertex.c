@@ -0,0 +1,61 @@
+#include "util.h"
+
+#include <aem/model.h>
+
+#include <stdint.h>
+
+static GLenum aem_vertex_attribute_type_to_gl(enum AEMVertexAttributeType type)
+{
+  switch (type)
+  {
+  case AEMVertexAttributeType_HalfFloat:
+    return GL_HALF_FLOAT;
+  case AEMVertexAttributeType_Int32:
+    return GL_INT;
+  case AEMVertexAttributeType_Int16:
+    return GL_SHORT;
+  case AEMVertexAttributeType_UInt16:
+    return GL_UNSIGNED_SHORT;
+  case AEMVertexAttributeType_Int8:
+    return GL_BYTE;
+  case AEMVertexAttributeType_UInt8:
+    return GL_UNSIGNED_BYTE;
+  default:
+    return GL_FLOAT;
+  }
+}
+
+void set_model_vertex_attributes(const struct AEMVertexLayout* layout, enum AEMVertexStream stream)
+{
+  // The attribute locations match the AEM vertex attributes
+  for (GLuint location = 0; location < AEMVertexAttribute_Count; ++location)
+  {
+    const struct AEMVertexAttributeLayout* attribute = &layout->attributes[location];
+    if (attribute->type == AEMVertexAttributeType_None)
+    {
+      glDisableVertexAttribArray(location);
+      continue;
+    }
+
+    if (attribute->stream != stream)
+    {
+      continue;
+    }
+
+    const GLenum type = aem_vertex_attribute_type_to_gl(attribute->type);
+    const void* offset = (void*)(uintptr_t)attribute->offset;
+
+    glEnableVertexAttribArray(location);
+
+    const bool is_integer = type != GL_FLOAT && type != GL_HALF_FLOAT && !attribute->normalized;
+    if (is_integer)
+    {
+      glVertexAttribIPointer(location, attribute->component_count, type, layout->strides[stream], offset);
+    }
+    else
+    {
+      glVertexAttribPointer(location, attribute->component_count, type, attribute->normalized ? GL_TRUE : GL_FALSE,
+                            layout->strides[stream], offset);
+    }
+  }
+}
@@ -7,7 +7,6 @@ struct GLFWwindow;
 struct DisplayState;
 struct SceneState;
 struct SkeletonState;
-struct AEMJoint;
 
 void init_gui(struct GLFWwindow* window,
               struct DisplayState* display_state,
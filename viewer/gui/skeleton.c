@@ -5,6 +5,8 @@
 
 #include <aem/model.h>
 
+#include <cglm/mat4.h>
+
 #define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
 #include <cimgui/cimgui.h>
 
@@ -15,7 +17,7 @@
 struct Node
 {
   uint32_t id;
-  struct AEMJoint* joint;
+  int32_t parent_index;
   struct Node** children;
   uint32_t child_count;
   uint32_t child_index; // Used when building the children array
@@ -36,7 +38,7 @@ void init_skeleton(struct SkeletonState* skeleton_state_)
 
 void skeleton_on_new_model()
 {
-  struct AEMJoint* joints = get_model_joints();
+  const int32_t* parent_joint_indices = get_model_joint_parent_indices();
   node_count = get_model_joint_count();
 
   if (node_count <= 0)
@@ -58,13 +60,13 @@ void skeleton_on_new_model()
     struct Node* node = &nodes[node_index];
 
     node->id = node_index;
-    node->joint = &joints[node_index];
+    node->parent_index = parent_joint_indices[node_index];
 
     node->translation_keyframe_count = get_model_joint_translation_keyframe_count(0, node_index);
     node->rotation_keyframe_count = get_model_joint_rotation_keyframe_count(0, node_index);
     node->scale_keyframe_count = get_model_joint_scale_keyframe_count(0, node_index);
 
-    const int32_t parent_index = node->joint->parent_joint_index;
+    const int32_t parent_index = node->parent_index;
     if (parent_index < 0)
     {
       continue;
@@ -87,7 +89,7 @@ void skeleton_on_new_model()
   {
     struct Node* node = &nodes[node_index];
 
-    const int32_t parent_index = node->joint->parent_joint_index;
+    const int32_t parent_index = node->parent_index;
     if (parent_index < 0)
     {
       continue;
@@ -108,7 +110,7 @@ static void draw_skeleton_tree(const struct Node* node)
   }
 
   char name[256];
-  sprintf(name, "#%u: \"%s\"", node->id, node->joint->name);
+  sprintf(name, "#%u: \"%s\"", node->id, get_model_joint_name(node->id));
   const bool open = igTreeNodeEx_Str(name, flags);
 
   if (igIsItemHovered(0) && igBeginTooltip())
@@ -117,6 +119,9 @@ static void draw_skeleton_tree(const struct Node* node)
 
     igText("Inverse bind matrix:");
 
+    mat4 inverse_bind_matrix;
+    get_model_joint_inverse_bind_matrix(node->id, inverse_bind_matrix);
+
     if (igBeginTable("InverseBindMatrix", 4, 0, (ImVec2){ 0, 0 }, 0.0f))
     {
       for (int row = 0; row < 4; row++)
@@ -125,7 +130,7 @@ static void draw_skeleton_tree(const struct Node* node)
         for (int column = 0; column < 4; column++)
         {
           igTableNextColumn();
-          igText("%f", node->joint->inverse_bind_matrix[column * 4 + row]);
+          igText("%f", inverse_bind_matrix[column][row]);
         }
       }
       igEndTable();
@@ -165,7 +170,7 @@ void update_skeleton(int screen_width, int screen_height)
   for (uint32_t node_index = 0; node_index < node_count; ++node_index)
   {
     struct Node* node = &nodes[node_index];
-    if (node->joint->parent_joint_index < 0)
+    if (node->parent_index < 0)
     {
       draw_skeleton_tree(&nodes[node_index]);
     }
@@ -18,7 +18,6 @@ static uint32_t texture_count;
 static GLuint* texture_handles;
 
 static uint32_t joint_count;
-static struct AEMJoint* joints;
 static mat4* joint_transforms;
 
 static uint32_t animation_count;
@@ -62,8 +61,6 @@ bool load_model(const char* filepath, const char* path)
 
   // Load joints
   {
-    joints = aem_get_model_joints(model);
-
     joint_transforms = malloc(joint_count * sizeof(mat4));
     for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
     {
@@ -76,10 +73,14 @@ bool load_model(const char* filepath, const char* path)
 
   // Fill the buffers of the model renderer
   {
-    const uint32_t vertex_buffer_size = get_model_vertex_count() * AEM_VERTEX_SIZE;
-    const uint32_t index_buffer_size = get_model_index_count() * AEM_INDEX_SIZE;
-    fill_model_renderer_buffers(vertex_buffer_size, get_model_vertex_buffer(), index_buffer_size,
-                                get_model_index_buffer(), joint_count);
+    const uint32_t vertex_format = aem_get_model_vertex_format(model);
+    const uint32_t vertex_count = get_model_vertex_count();
+    const uint32_t vertex_buffer_size = vertex_count * aem_get_vertex_size(vertex_format, AEMVertexStream_Vertices);
+    const uint32_t position_buffer_size = vertex_count * aem_get_vertex_size(vertex_format, AEMVertexStream_Positions);
+    const uint64_t index_buffer_size = aem_get_model_index_buffer_size(model);
+    fill_model_renderer_buffers(vertex_format, vertex_buffer_size, get_model_vertex_buffer(), position_buffer_size,
+                                aem_get_model_position_buffer(model), index_buffer_size, get_model_index_buffer(),
+                                joint_count);
   }
 
   return true;
@@ -131,9 +132,19 @@ uint32_t get_model_joint_count()
   return joint_count;
 }
 
-struct AEMJoint* get_model_joints()
+const int32_t* get_model_joint_parent_indices()
+{
+  return aem_get_model_joint_parent_indices(model);
+}
+
+const char* get_model_joint_name(uint32_t joint_index)
+{
+  return aem_get_model_joint_name(model, joint_index);
+}
+
+void get_model_joint_inverse_bind_matrix(uint32_t joint_index, mat4 inverse_bind_matrix)
 {
-  return joints;
+  aem_get_model_joint_inverse_bind_matrix(model, joint_index, (float*)inverse_bind_matrix);
 }
 
 uint32_t get_model_animation_count()
@@ -252,6 +263,14 @@ void model_update_animation(float delta_time)
   }
 }
 
+static void draw_mesh(const struct AEMMesh* mesh)
+{
+  const GLenum index_type = mesh->index_type == AEMIndexType_UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  const uint64_t index_offset = (uint64_t)mesh->first_index * aem_get_index_size(mesh->index_type);
+  glDrawElementsBaseVertex(GL_TRIANGLES, mesh->index_count, index_type, (void*)(uintptr_t)index_offset,
+                           mesh->base_vertex);
+}
+
 void draw_model_opaque()
 {
   glBufferData(GL_TEXTURE_BUFFER, sizeof(mat4) * joint_count, joint_transforms, GL_DYNAMIC_DRAW);
@@ -274,8 +293,7 @@ void draw_model_opaque()
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, texture_handles[material->pbr_texture_index]);
 
-    glDrawElements(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT,
-                   (void*)(uintptr_t)(mesh->first_index * AEM_INDEX_SIZE));
+    draw_mesh(mesh);
   }
 }
 
@@ -308,8 +326,7 @@ void draw_model_transparent()
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, texture_handles[material->pbr_texture_index]);
 
-    glDrawElements(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT,
-                   (void*)(uintptr_t)(mesh->first_index * AEM_INDEX_SIZE));
+    draw_mesh(mesh);
   }
 
   // Reset OpenGL state
@@ -323,7 +340,6 @@ void draw_model_wireframe()
   for (uint32_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
   {
     const struct AEMMesh* mesh = aem_get_model_mesh(model, mesh_index);
-    glDrawElements(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT,
-                   (void*)(uintptr_t)(mesh->first_index * AEM_INDEX_SIZE));
+    draw_mesh(mesh);
   }
 }
\ No newline at end of file
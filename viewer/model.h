@@ -18,7 +18,9 @@ void* get_model_index_buffer();
 uint32_t get_model_index_count();
 
 uint32_t get_model_joint_count();
-struct AEMJoint* get_model_joints();
+const int32_t* get_model_joint_parent_indices();
+const char* get_model_joint_name(uint32_t joint_index);
+void get_model_joint_inverse_bind_matrix(uint32_t joint_index, mat4 inverse_bind_matrix);
 
 struct AEMAnimationChannel* get_model_animation_channel(uint32_t channel_index);
 
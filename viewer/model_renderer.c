@@ -6,12 +6,12 @@
 
 #include <stdio.h>
 
-static GLuint vertex_array, vertex_buffer, index_buffer, joint_transform_buffer, joint_transform_texture;
+static GLuint vertex_array, vertex_buffer, position_buffer, index_buffer, joint_transform_buffer, joint_transform_texture;
 
 static GLuint shader_program;
 static GLint pass_uniform_location, ambient_color_uniform_location, light_dir_uniform_location, light_color_uniform_location,
   camera_pos_uniform_location, render_mode_uniform_location, postprocessing_mode_uniform_location,
-  world_uniform_location, viewproj_uniform_location;
+  world_uniform_location, viewproj_uniform_location, vertex_format_uniform_location;
 
 bool load_model_renderer()
 {
@@ -19,43 +19,13 @@ bool load_model_renderer()
   glBindVertexArray(vertex_array);
 
   glGenBuffers(1, &vertex_buffer);
+  glGenBuffers(1, &position_buffer);
   glGenBuffers(1, &index_buffer);
   glGenBuffers(1, &joint_transform_buffer);
 
   glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
 
-  // Apply the vertex definition
-  {
-    // Position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(0 * 4));
-
-    // Normal
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(3 * 4));
-
-    // Tangent
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(6 * 4));
-
-    // Bitangent
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(9 * 4));
-
-    // UV
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(12 * 4));
-
-    // Joint indices
-    glEnableVertexAttribArray(5);
-    glVertexAttribIPointer(5, 4, GL_INT, AEM_VERTEX_SIZE, (void*)(14 * 4));
-
-    // Joint weights
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, AEM_VERTEX_SIZE, (void*)(18 * 4));
-  }
-
   // Generate shader program
   {
     GLuint vertex_shader, fragment_shader;
@@ -87,6 +57,7 @@ bool load_model_renderer()
       camera_pos_uniform_location = get_uniform_location(shader_program, "camera_pos");
       render_mode_uniform_location = get_uniform_location(shader_program, "render_mode");
       postprocessing_mode_uniform_location = get_uniform_location(shader_program, "postprocessing_mode");
+      vertex_format_uniform_location = get_uniform_location(shader_program, "vertex_format");
 
       const GLint joint_transform_tex_uniform_location = get_uniform_location(shader_program, "joint_transform_tex");
       glUniform1i(joint_transform_tex_uniform_location, 0);
@@ -116,18 +87,36 @@ void destroy_model_renderer()
   glDeleteBuffers(1, &joint_transform_buffer);
   glDeleteBuffers(1, &index_buffer);
   glDeleteBuffers(1, &vertex_buffer);
+  glDeleteBuffers(1, &position_buffer);
 
   glDeleteVertexArrays(1, &vertex_array);
 }
 
-void fill_model_renderer_buffers(GLsizeiptr model_vertex_buffer_size,
+void fill_model_renderer_buffers(uint32_t model_vertex_format,
+                                 GLsizeiptr model_vertex_buffer_size,
                                  const void* model_vertex_buffer,
+                                 GLsizeiptr model_position_buffer_size,
+                                 const void* model_position_buffer,
                                  GLsizeiptr model_index_buffer_size,
                                  const void* model_index_buffer,
                                  uint32_t joint_count)
 {
+  glBindVertexArray(vertex_array);
+
+  // Apply the vertex definition, split vertex formats keep positions and skinning data in a buffer of their own
+  glUseProgram(shader_program);
+  glUniform1i(vertex_format_uniform_location, (GLint)model_vertex_format);
+
+  struct AEMVertexLayout vertex_layout;
+  aem_get_vertex_layout(model_vertex_format, &vertex_layout);
+
+  glBindBuffer(GL_ARRAY_BUFFER, position_buffer);
+  glBufferData(GL_ARRAY_BUFFER, model_position_buffer_size, model_position_buffer, GL_STATIC_DRAW);
+  set_model_vertex_attributes(&vertex_layout, AEMVertexStream_Positions);
+
   glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
   glBufferData(GL_ARRAY_BUFFER, model_vertex_buffer_size, model_vertex_buffer, GL_STATIC_DRAW);
+  set_model_vertex_attributes(&vertex_layout, AEMVertexStream_Vertices);
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, model_index_buffer_size, model_index_buffer, GL_STATIC_DRAW);
@@ -18,8 +18,11 @@ typedef enum
 bool load_model_renderer();
 void destroy_model_renderer();
 
-void fill_model_renderer_buffers(GLsizeiptr model_vertex_buffer_size,
+void fill_model_renderer_buffers(uint32_t model_vertex_format,
+                                 GLsizeiptr model_vertex_buffer_size,
                                  const void* model_vertex_buffer,
+                                 GLsizeiptr model_position_buffer_size, // 0 unless the vertex format is split
+                                 const void* model_position_buffer,
                                  GLsizeiptr model_index_buffer_size,
                                  const void* model_index_buffer,
                                  uint32_t joint_count);
@@ -101,15 +101,14 @@ void destroy_skeleton_overlay()
 
 void skeleton_overlay_on_new_model_loaded()
 {
-  struct AEMJoint* joints = get_model_joints();
+  const int32_t* parent_joint_indices = get_model_joint_parent_indices();
   const uint32_t joint_count = get_model_joint_count();
 
   // Count the number of bones (connections between joints)
   point_count = 0;
   for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
   {
-    const struct AEMJoint* joint = &joints[joint_index];
-    if (joint->parent_joint_index >= 0)
+    if (parent_joint_indices[joint_index] >= 0)
     {
       point_count += 2;
     }
@@ -124,27 +123,25 @@ void skeleton_overlay_on_new_model_loaded()
   uint32_t point_index = 0;
   for (uint32_t joint_index = 0; joint_index < joint_count; ++joint_index)
   {
-    struct AEMJoint* joint = &joints[joint_index];
-    if (joint->parent_joint_index < 0)
+    const int32_t parent_joint_index = parent_joint_indices[joint_index];
+    if (parent_joint_index < 0)
     {
       continue;
     }
 
-    struct AEMJoint* parent_joint = &joints[joint->parent_joint_index];
-
     {
       mat4 bind_matrix;
-      glm_mat4_make(parent_joint->inverse_bind_matrix, bind_matrix);
+      get_model_joint_inverse_bind_matrix(parent_joint_index, bind_matrix);
       glm_mat4_inv(bind_matrix, bind_matrix);
       glm_mat4_mulv3(bind_matrix, GLM_VEC3_ZERO, 1.0f, points[point_index].position);
 
-      points[point_index].joint_index = joint->parent_joint_index;
+      points[point_index].joint_index = parent_joint_index;
       ++point_index;
     }
 
     {
       mat4 bind_matrix;
-      glm_mat4_make(joint->inverse_bind_matrix, bind_matrix);
+      get_model_joint_inverse_bind_matrix(joint_index, bind_matrix);
       glm_mat4_inv(bind_matrix, bind_matrix);
       glm_mat4_mulv3(bind_matrix, GLM_VEC3_ZERO, 1.0f, points[point_index].position);
 
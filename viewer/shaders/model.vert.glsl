@@ -4,10 +4,13 @@ uniform mat4 world;
 uniform mat4 viewproj;
 uniform samplerBuffer joint_transform_tex;
 
+const int VERTEX_FORMAT_QUANTIZED = 1; // Matches AEM_VERTEX_FORMAT_QUANTIZED
+uniform int vertex_format;
+
 layout(location = 0) in vec3 in_position;
-layout(location = 1) in vec3 in_normal;
-layout(location = 2) in vec3 in_tangent;
-layout(location = 3) in vec3 in_bitangent;
+layout(location = 1) in vec3 in_normal;    // Octahedral-encoded in xy if quantized
+layout(location = 2) in vec4 in_tangent;   // Octahedral-encoded in xy and bitangent sign in z if quantized
+layout(location = 3) in vec3 in_bitangent; // Not used if quantized
 layout(location = 4) in vec2 in_uv;
 layout(location = 5) in ivec4 in_joint_indices;
 layout(location = 6) in vec4 in_joint_weights;
@@ -30,10 +33,27 @@ mat4 get_joint_transform(int index) {
     );
 }
 
+vec3 decode_octahedral(vec2 e) {
+  vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-v.z, 0.0);
+  v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+  return normalize(v);
+}
+
 void main()
 {
+  vec3 normal = in_normal;
+  vec3 tangent = in_tangent.xyz;
+  vec3 bitangent = in_bitangent;
+  if ((vertex_format & VERTEX_FORMAT_QUANTIZED) != 0) {
+    normal = decode_octahedral(in_normal.xy);
+    tangent = decode_octahedral(in_tangent.xy);
+    bitangent = cross(normal, tangent) * in_tangent.z;
+  }
+
+  // Unskinned vertices have no weights, quantized joint indices are unsigned and can't be negative
   mat4 joint_transform = mat4(1.0);
-  if (in_joint_indices[0] >= 0) {
+  if (dot(in_joint_weights, vec4(1.0)) > 0.0) {
     joint_transform = get_joint_transform(in_joint_indices[0]) * in_joint_weights[0];
     for (int i = 1; i < 4; ++i)
     {
@@ -43,9 +63,9 @@ void main()
 
   o.position = (world * joint_transform * vec4(in_position, 1)).xyz;
 
-  o.normal = normalize((world * joint_transform * vec4(in_normal, 0)).xyz);
-  o.tangent = normalize((world * joint_transform * vec4(in_tangent, 0)).xyz);
-  o.bitangent = normalize((world * joint_transform * vec4(in_bitangent, 0)).xyz);
+  o.normal = normalize((world * joint_transform * vec4(normal, 0)).xyz);
+  o.tangent = normalize((world * joint_transform * vec4(tangent, 0)).xyz);
+  o.bitangent = normalize((world * joint_transform * vec4(bitangent, 0)).xyz);
 
   o.uv = in_uv;
   